@@ -0,0 +1,103 @@
+/*
+  hw-status.js - Component status table for the IoTApplication web UI.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.  License: LGPL-2.1+
+
+  Served gzipped from PROGMEM as /hw-status.js. After editing, regenerate
+  src/IoTGeneratedAssets.h:
+    tools/gzip_assets.py -o src/IoTGeneratedAssets.h data/hw-status.js
+*/
+(function () {
+  'use strict';
+
+  var POLL_MS = 5000;
+  var script = document.currentScript;
+  var table = document.getElementById('hwstatus');
+  if (!table) {
+    table = document.createElement('table');
+    table.id = 'hwstatus';
+    script.parentNode.insertBefore(table, script.nextSibling);
+  }
+
+  // One row per component object: name, value with unit, switch toggle
+  function row(c) {
+    var tr = document.createElement('tr');
+    var name = document.createElement('td');
+    var value = document.createElement('td');
+    name.textContent = c.name || '';
+    value.textContent = c.value + (c.unit ? ' ' + c.unit : '');
+    tr.appendChild(name);
+    tr.appendChild(value);
+    if (c.type === 'switch' && c.uid) {
+      var td = document.createElement('td');
+      var btn = document.createElement('button');
+      btn.textContent = c.state ? 'Off' : 'On';
+      btn.onclick = function () {
+        btn.disabled = true;
+        fetch('/api/switch?id=' + encodeURIComponent(c.uid) + '&state=' + (c.state ? 0 : 1))
+          .then(refresh, refresh);
+      };
+      td.appendChild(btn);
+      tr.appendChild(td);
+    }
+    return tr;
+  }
+
+  var rows = {};
+
+  function key(c, i) { return c.uid || c.name || String(i); }
+
+  function render(list) {
+    table.textContent = '';
+    rows = {};
+    list.forEach(function (c, i) {
+      var tr = row(c);
+      rows[key(c, i)] = tr;
+      table.appendChild(tr);
+    });
+  }
+
+  // Replace the rows of the components in a delta event, append new ones
+  function patch(list) {
+    list.forEach(function (c, i) {
+      var k = key(c, i);
+      var tr = row(c);
+      if (rows[k]) {
+        table.replaceChild(tr, rows[k]);
+      } else {
+        table.appendChild(tr);
+      }
+      rows[k] = tr;
+    });
+  }
+
+  var timer = null;
+
+  function refresh() {
+    // System queries are answered by the page that loads this script
+    return fetch(location.pathname + '?dx=hwstatus')
+      .then(function (r) { return r.json(); })
+      .then(render, function () {});
+  }
+
+  function poll() {
+    if (timer === null) {
+      refresh();
+      timer = setInterval(refresh, POLL_MS);
+    }
+  }
+
+  // Push updates over /api/events; poll when the stream is unavailable
+  // (old browser, HA support disabled or all stream slots busy)
+  if (window.EventSource) {
+    var es = new EventSource('/api/events');
+    es.addEventListener('full', function (e) { render(JSON.parse(e.data)); });
+    es.addEventListener('delta', function (e) { patch(JSON.parse(e.data)); });
+    es.onerror = function () {
+      if (es.readyState === EventSource.CLOSED) {
+        poll();
+      }
+    };
+  } else {
+    poll();
+  }
+})();
@@ -28,6 +28,13 @@
 #include "WifiSettings.h"
 #include "MQTTSettings.h"
 #include "Version.h"
+#include "IoTStaticAsset.h"
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+    #include "IoTHASwitchWrapper.h"
+#endif
+#if __has_include("IoTGeneratedAssets.h")
+    #include "IoTGeneratedAssets.h" // tools/gzip_assets.py
+#endif
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -38,6 +45,59 @@
 namespace
 {
     unsigned long ota_progress_millis = 0;
+
+    const char contentTypeJs[] PROGMEM = "application/javascript";
+
+    IoTSystemEvent settingsChangedEvent(const Settings& settings)
+    {
+        IoTSystemEvent e;
+        e.type   = IoTSystemEvent::Type::SETTINGS_CHANGED;
+        e.source = settings.name();
+        return e;
+    }
+
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+    // "uid1:1,uid2:0" -> batch; false on syntax error or too many items
+    bool parseSwitchBatch(const String& list, IoTCommandMailbox::Batch& batch)
+    {
+        int start = 0;
+        while (start < static_cast<int>(list.length()))
+        {
+            int end = list.indexOf(',', start);
+            if (end < 0)
+            {
+                end = list.length();
+            }
+            const int colon = list.indexOf(':', start);
+            if (colon <= start || colon + 2 != end
+                || (list[colon + 1] != '0' && list[colon + 1] != '1'))
+            {
+                return false;
+            }
+            if (!batch.add(list.c_str() + start, colon - start, list[colon + 1] == '1'))
+            {
+                return false;
+            }
+            start = end + 1;
+        }
+        return batch.size() > 0;
+    }
+
+    String switchBatchResultJSON(const IoTCommandMailbox::Batch& batch, uint32_t appliedMask)
+    {
+        String items;
+        for (uint8_t i = 0; i < batch.size(); ++i)
+        {
+            if (i) items += ',';
+            items += JSONUtils::EncloseObject(
+                JSONUtils::Pair(F("id"), batch.uid(i), true) +
+                String(F(",\"ok\":")) + ((appliedMask & (1UL << i)) ? F("true") : F("false")));
+        }
+        const bool allApplied = appliedMask == (0xFFFFFFFFUL >> (32 - batch.size()));
+        return String(F("{\"ok\":")) + (allApplied ? F("true") : F("false"))
+            + F(",\"results\":") + JSONUtils::EncloseArray(items) + '}';
+    }
+#endif
 }
 
 
@@ -45,19 +105,29 @@ IoTApplication::IoTApplication(IoTDevice* pIoTDevice) :
     _pIoTDevice(pIoTDevice),
     _webServer(80),
     //_wm(&_webServer, &_dnsServer),
-    _automaticUpdateTimer(15*1000),
+    _automaticUpdateTimer(AUTOMATIC_UPDATE_MS),
     _wifiUpdateTimer(60*1000)
     //_timeZone(pIoTDevice->deviceProperties().dstStart, pIoTDevice->deviceProperties().stdStart),
 #ifdef _IOT_REAL_TIME
-    ,_ntpClient(_ntpUDP, "europe.pool.ntp.org", 0, 300000UL)
+    ,_ntpClient(300000UL)
+    ,_timezone(pIoTDevice->deviceProperties().dstStart, pIoTDevice->deviceProperties().stdStart)
 #endif
 #ifdef WM_SUPPORT_HOME_ASSISTANT
-    ,_mqtt(_wifiClient, pIoTDevice->device())
+    ,_mqtt(_wifiClient, pIoTDevice->device(), IOT_MAX_HA_DEVICE_TYPES)
 #endif
 {
+    // Before any route: the server picks the first handler that accepts a request
+    _webServer.addHandler(&_httpAdmission);
+
     _pWiFiManager = new IoTWiFiManager(&_webServer, &_dnsServer);
     _pWiFiManager->setApplication(this);
     _pWiFiManager->setHardwareId(pIoTDevice->deviceProperties().hardwareId);
+
+#ifdef _IOT_REAL_TIME
+    _ntpClient.addServer("europe.pool.ntp.org");
+    _ntpClient.addServer("pool.ntp.org");
+    _ntpClient.addServer("time.cloudflare.com");
+#endif
 }
 
 IoTApplication::~IoTApplication()
@@ -68,7 +138,14 @@ IoTApplication::~IoTApplication()
 void IoTApplication::registerCommonRoutes()
 {
     _webServer.on("/hw-status.js", HTTP_GET, [](AsyncWebServerRequest* req) {
-        req->send_P(200, "application/javascript", WM_PK_HW_STATUS_JS);
+#ifdef IOT_ASSET_HW_STATUS_JS_GZ
+        sendStaticAsset(req, IOT_ASSET_HW_STATUS_JS);
+#else
+        static char etag[11];
+        static const IoTStaticAsset asset = makeStaticAsset(
+            contentTypeJs, WM_PK_HW_STATUS_JS, etag);
+        sendStaticAsset(req, asset);
+#endif
     });
 #ifdef WM_SUPPORT_HOME_ASSISTANT
     _webServer.on("/api/switch", HTTP_GET, [this](AsyncWebServerRequest* request) {
@@ -78,12 +155,89 @@ void IoTApplication::registerCommonRoutes()
                 request, String(F("{\"ok\":false,\"error\":\"missing args\"}")));
             return;
         }
-        const String& uid = request->arg("id");
-        bool state = (request->arg("state") == "1");
-        bool ok = _pIoTDevice->dispatchWebCommand(uid.c_str(), state);
-        ESPAsync_WiFiManagerUtils::responseApplJson(
-            request, String(F("{\"ok\":")) + (ok ? F("true") : F("false")) + F("}"));
+        // Components are only touched from loop(): queue the command and
+        // complete the response once loop() has applied it.
+        const uint32_t id = _commandMailbox.post(request->arg("id").c_str(),
+                                                 request->arg("state") == "1");
+        if (id == 0)
+        {
+            ESPAsync_WiFiManagerUtils::responseApplJson(
+                request, String(F("{\"ok\":false,\"error\":\"busy\"}")));
+            return;
+        }
+        const uint32_t postedMs = millis();
+        request->send(request->beginChunkedResponse("application/json",
+            [this, id, postedMs](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+                if (index > 0)
+                {
+                    return 0;   // body complete
+                }
+                const IoTCommandMailbox::Result r = _commandMailbox.result(id);
+                if (r == IoTCommandMailbox::Result::PENDING && millis() - postedMs < COMMAND_TIMEOUT_MS)
+                {
+                    return RESPONSE_TRY_AGAIN;
+                }
+                const char* body = r == IoTCommandMailbox::Result::APPLIED   ? "{\"ok\":true}"
+                                 : r == IoTCommandMailbox::Result::NOT_FOUND ? "{\"ok\":false}"
+                                 : "{\"ok\":false,\"error\":\"timeout\"}";
+                size_t len = strlen(body);
+                if (len > maxLen)
+                {
+                    len = maxLen;
+                }
+                memcpy(buffer, body, len);
+                return len;
+            }));
+    });
+    // /api/switches?set=uid1:1,uid2:0 - all items applied in the same loop() pass
+    _webServer.on("/api/switches", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        IoTCommandMailbox::Batch batch;
+        if (!request->hasArg("set") || !parseSwitchBatch(request->arg("set"), batch))
+        {
+            ESPAsync_WiFiManagerUtils::responseApplJson(
+                request, String(F("{\"ok\":false,\"error\":\"bad args\"}")));
+            return;
+        }
+        const uint32_t id = _commandMailbox.post(batch);
+        if (id == 0)
+        {
+            ESPAsync_WiFiManagerUtils::responseApplJson(
+                request, String(F("{\"ok\":false,\"error\":\"busy\"}")));
+            return;
+        }
+        const uint32_t postedMs = millis();
+        request->send(request->beginChunkedResponse("application/json",
+            [this, id, postedMs, batch, body = String()](uint8_t* buffer, size_t maxLen, size_t index) mutable -> size_t {
+                if (index == 0)
+                {
+                    uint32_t appliedMask = 0;
+                    if (!_commandMailbox.batchResult(id, appliedMask))
+                    {
+                        if (millis() - postedMs < COMMAND_TIMEOUT_MS)
+                        {
+                            return RESPONSE_TRY_AGAIN;
+                        }
+                        body = F("{\"ok\":false,\"error\":\"timeout\"}");
+                    }
+                    else
+                    {
+                        body = switchBatchResultJSON(batch, appliedMask);
+                    }
+                }
+                if (index >= body.length())
+                {
+                    return 0;   // body complete
+                }
+                size_t len = body.length() - index;
+                if (len > maxLen)
+                {
+                    len = maxLen;
+                }
+                memcpy(buffer, body.c_str() + index, len);
+                return len;
+            }));
     });
+    _statusStream.begin(_webServer, "/api/events", _pIoTDevice->statusSnapshot());
 #endif
 }
 
@@ -98,23 +252,26 @@ void IoTApplication::registerRootHandler(ArRequestFilterFunction filter)
 
 void IoTApplication::registerSystemEventCallbacks()
 {
+    // These callbacks run in SDK / async TCP context; they only queue the
+    // event and loop() delivers it, see dispatchSystemEvents().
     _pWiFiManager->onOTAStart([this]() {
-        _pIoTDevice->onSystemEvent({IoTSystemEvent::Type::OTA_START});
+        _systemEvents.push({IoTSystemEvent::Type::OTA_START});
     });
     _pWiFiManager->onOTAProgress([this](size_t current, size_t total) {
         IoTSystemEvent e;
         e.type = IoTSystemEvent::Type::OTA_PROGRESS;
         e.arg1 = (uint32_t)current;
         e.arg2 = (uint32_t)total;
-        _pIoTDevice->onSystemEvent(e);
+        _systemEvents.push(e);
     });
     _pWiFiManager->onOTAEnd([this](bool success) {
         IoTSystemEvent e;
         e.type = IoTSystemEvent::Type::OTA_END;
         e.flag = success;
-        _pIoTDevice->onSystemEvent(e);
+        _systemEvents.push(e);
     });
     _pWiFiManager->onPreReboot([this]() {
+        // The reboot follows right away, loop() would never see a queued event.
         _pIoTDevice->onSystemEvent({IoTSystemEvent::Type::RESTARTING});
     });
 
@@ -124,30 +281,42 @@ void IoTApplication::registerSystemEventCallbacks()
             IoTSystemEvent e;
             e.type = IoTSystemEvent::Type::WIFI_CONNECTED;
             e.arg1 = (uint32_t)ev.ip;
-            _pIoTDevice->onSystemEvent(e);
-#ifdef _IOT_REAL_TIME
-            _bNeedsTimeSync = true;
-#endif
+            _systemEvents.push(e);
         });
     _wifiDisconnectHandler = WiFi.onStationModeDisconnected(
         [this](const WiFiEventStationModeDisconnected&) {
-            _pIoTDevice->onSystemEvent({IoTSystemEvent::Type::WIFI_DISCONNECTED});
+            _systemEvents.push({IoTSystemEvent::Type::WIFI_DISCONNECTED});
         });
 #endif
 }
 
+void IoTApplication::dispatchSystemEvents()
+{
+    _systemEvents.drain([this](const IoTSystemEvent& e) {
+#ifdef _IOT_REAL_TIME
+        if (e.type == IoTSystemEvent::Type::WIFI_CONNECTED)
+        {
+            _bNeedsTimeSync = true;
+        }
+#endif
+        _pIoTDevice->onSystemEvent(e);
+    });
+}
+
 void IoTApplication::setup()
 {
     Serial.begin(115200);
-    delay(500);
+    if (!_bFastBoot)
+    {
+        delay(500);
+    }
     Serial.println(F("IoTApplication::setup()"));
 
     _appSettings.read();
     IOTLOGINFO1(F("Temperature unit: "), _appSettings.temperatureInCelsius() ? F("Celsius") : F("Fahrenheit"));
 
 #ifdef WM_SUPPORT_HOME_ASSISTANT
-    MQTTSettings mqttSettings;
-    mqttSettings.read();
+    _mqttSettings.read();
 #endif
 
     _pIoTDevice->preSetup();
@@ -191,7 +360,10 @@ void IoTApplication::setup()
     // Setup SPI
     //SPI.begin();
 
-    delay(1000);
+    if (!_bFastBoot)
+    {
+        delay(1000);
+    }
 
     WiFiSettings wifiSettings("WIFI");
     // Read WiFi settings
@@ -203,187 +375,336 @@ void IoTApplication::setup()
         configure();
     }
 
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+    if (_dutyCycle.enabled())
+    {
+        // Sample once; when nothing changed go back to sleep without WiFi
+        _dutyCycle.restore(_pIoTDevice->componentCount());
+        _pIoTDevice->updateAllComponents(true);
+        if (!_dutyCycle.evaluate(*_pIoTDevice))
+        {
+            _dutyCycle.sleep(false);
+        }
+    }
+#endif
+
     // Timer timers
 
-    String ssid(wifiSettings.SSID());
-    String pwd(wifiSettings.password());
-    if (!ssid.isEmpty())
+    if (!wifiSettings.SSID().isEmpty())
     {
-        IOTLOGDEBUG1(F("SSIS: "), ssid);
-        IOTLOGDEBUG1(F("Password: "), pwd);
+        IOTLOGDEBUG1(F("SSIS: "), wifiSettings.SSID().c_str());
+        IOTLOGDEBUG1(F("Password: "), wifiSettings.password().c_str());
         //WiFi.hostname("_IoTApplicationTest1");
         //WiFi.setPhyMode(WIFI_PHY_MODE_11N);
         WiFi.mode(WIFI_STA);
-        WiFi.begin(ssid.c_str(), pwd.c_str());
+        _wifiBeginMs = millis();
+        _wifiConnection.begin();
         WiFi.setSleep(false);
+        _idle.applyRadioSleep();
 
-        //
-        IOTLOGDEBUG(F("Connecting to WiFi: "));
-        uint8_t attempts = 0;
-        while ( WiFi.status() != WL_CONNECTED &&
-                attempts < 5)
+        if (_bFastBoot)
         {
-            Serial.print (".");
-            delay (1000);
-            attempts++;
-        }
-
-        if (WiFi.status() == WL_CONNECTED)
-        {
-            IOTLOGDEBUG(F(". Connected"));
-            IOTLOGDEBUG1(F("IP:"), WiFi.localIP());
+            // loop() finishes the bring-up, see advanceBootState()
+            _bootState = BootState::WIFI_CONNECTING;
         }
         else
         {
-            IOTLOGDEBUG(F(". Not connected"));
-        }
-
-        delay(1000);
-
-        _bUsingWiFi = true;
-
-        /*
-        byte str[16] = { 0xA, 0x1, 0x5, 0xB, 0xF, 0x4, 0x2, 0xF, 0xE, 0xB, 0x2, 0x6, 0x8, 0x7, 0x9, 0x3 };
-        m_HAdevice.setUniqueId(str, 16);
-
-        // Set other device properties
-        m_HAdevice.setName("Solar Controller Test 1");
-        m_HAdevice.setModel("SCTest1");
-        m_HAdevice.setSoftwareVersion("1.0.0");
-        m_HAdevice.setAvailability(true);
-        m_HAdevice.setManufacturer("DIY");
-        */
-
-        // MQTT broker connection (use your data here)
-        //m_mqtt.begin(HA_MQTT_BROKER, HA_MQTT_PORT, HA_MQTT_USER, HA_MQTT_PASSWORD);
-
-    #ifdef WM_SUPPORT_HOME_ASSISTANT
-        IPAddress ipAddress;
-        if (ipAddress.fromString(mqttSettings.MQTTServer().c_str()))
-        {
-            // MQTT broker connection using IP address
-            _mqtt.begin(ipAddress, mqttSettings.MQTTPort(),
-                mqttSettings.MQTTUser().c_str(), mqttSettings.MQTTPassword().c_str());
-            IOTLOGINFO("MQTT connecting using IP address");
-        }
-        else
-        {
-            // MQTT broker connection using server name
-            _mqtt.begin(mqttSettings.MQTTServer().c_str(), mqttSettings.MQTTPort(),
-                mqttSettings.MQTTUser().c_str(), mqttSettings.MQTTPassword().c_str());
-            IOTLOGINFO("MQTT connecting using server name");
-        }
-    #endif
-
-        // Configure sensors
-        /*
-        m_tankTempSensor.setIcon("mdi:thermometer");
-        m_tankTempSensor.setName("Teplota nádrže");
-        m_tankTempSensor.setUnitOfMeasurement("°C");
-        m_tankTempSensor.setDeviceClass("temperature");
-        m_tankTempSensor.setForceUpdate(true);
-
-        m_tankErrorSensor.setName("Sensor teploty nádrže");
-        m_tankErrorSensor.setForceUpdate(true);
-        */
-
-        /*
-        _webServer.on("/", HTTP_GET, [this](AsyncWebServerRequest *request) {
-            String str(F("Hi! This is ElegantOTA AsyncDemo.\r\n"));
-            str += F("Version: ");
-            str += FPSTR(this->_pIoTDevice->deviceProperties().versionString);
-            request->send(200, "text/plain", str);
-        });
-        */
-
-        _pIoTDevice->onAddConfigRoutes(_webServer);
-        registerCommonRoutes();
-        registerRootHandler(ON_STA_FILTER);
-        registerSystemEventCallbacks();
-
-        _pWiFiManager->handleSTA();
-
-        _webServer.on("/api/appsave", HTTP_POST, [this](AsyncWebServerRequest *request) {
-            if (request->hasArg("temp_unit"))
+            //
+            IOTLOGDEBUG(F("Connecting to WiFi: "));
+            while (!_wifiConnection.loop() &&
+                   millis() - _wifiBeginMs < WIFI_CONNECT_TIMEOUT_MS)
             {
-                const String unit = request->arg("temp_unit");
-                _appSettings.setTemperatureInCelsius(unit != "F");
-                if (_appSettings.isDirty())
-                {
-                    _appSettings.save();
-                    IOTLOGINFO1(F("Temperature unit saved: "), unit);
-                }
+                Serial.print (".");
+                delay (250);
             }
-            ESPAsync_WiFiManagerUtils::responseApplJson(request, String(F("{\"result\":\"ok\"}")));
-        });
 
-        /*
-        ElegantOTA.begin(&_webServer);    // Start ElegantOTA
-        // ElegantOTA callbacks
-        ElegantOTA.onStart([]() {
-            // Log when OTA has started
-            Serial.println("OTA update started!");
-            // <Add your own code here>
-        });
-        ElegantOTA.onProgress([](size_t current, size_t final) {
-            // Log every 1 second
-            if (millis() - ota_progress_millis > 1000) {
-                ota_progress_millis = millis();
-                Serial.printf("OTA Progress Current: %u bytes, Final: %u bytes\n", current, final);
+            if (WiFi.status() == WL_CONNECTED)
+            {
+                IOTLOGDEBUG(F(". Connected"));
+                IOTLOGDEBUG1(F("IP:"), WiFi.localIP());
             }
-        });
-        ElegantOTA.onEnd([](bool success) {
-            // Log when OTA has finished
-            if (success) {
-                Serial.println("OTA update finished successfully!");
-            } else {
-                Serial.println("There was an error during OTA update!");
+            else
+            {
+                IOTLOGDEBUG(F(". Not connected"));
             }
-            // <Add your own code here>
-        });
-        */
 
-        _webServer.begin();
+            delay(1000);
+
+            startNetworkServices();
+        }
     }
 
-    // Setup time
-    setupTime();
+    // Setup time (fast boot does it from loop() once WiFi is up)
+    if (_bootState == BootState::RUNNING)
+    {
+        setupTime();
+    }
 
 #ifdef WM_SUPPORT_HOME_ASSISTANT
-    IOTLOGINFO2(F("MQTT server: |"), mqttSettings.MQTTServer(), F("|"));
-    IOTLOGINFO2(F("MQTT port: |"), mqttSettings.MQTTPort(), F("|"));
-    IOTLOGINFO2(F("MQTT user: |"), mqttSettings.MQTTUser(), F("|"));
-    IOTLOGINFO2(F("MQTT password: |"), mqttSettings.MQTTPassword(), F("|"));
+    IOTLOGINFO2(F("MQTT server: |"), _mqttSettings.MQTTServer().c_str(), F("|"));
+    IOTLOGINFO2(F("MQTT port: |"), _mqttSettings.MQTTPort(), F("|"));
+    IOTLOGINFO2(F("MQTT user: |"), _mqttSettings.MQTTUser().c_str(), F("|"));
+    IOTLOGINFO2(F("MQTT password: |"), _mqttSettings.MQTTPassword().c_str(), F("|"));
 
     IOTLOGINFO1(F("_ESPASYNC_WIFIMGR_LOGLEVEL_: "), _ESPASYNC_WIFIMGR_LOGLEVEL_);
 #endif // WM_SUPPORT_HOME_ASSISTANT
 
-    delay(500);
+    if (!_bFastBoot)
+    {
+        delay(500);
+    }
 
     // Prime all components so the display shows real values on the first tick
     // instead of "------" for up to 15 seconds (the automatic update timer period).
 #ifdef WM_SUPPORT_HOME_ASSISTANT
-    _pIoTDevice->updateAllComponents(true);
+    if (!_dutyCycle.enabled())
+    {
+        _pIoTDevice->updateAllComponents(true);
+    }
 #endif
 }
 
+void IoTApplication::startNetworkServices()
+{
+    _bUsingWiFi = true;
+
+    /*
+    byte str[16] = { 0xA, 0x1, 0x5, 0xB, 0xF, 0x4, 0x2, 0xF, 0xE, 0xB, 0x2, 0x6, 0x8, 0x7, 0x9, 0x3 };
+    m_HAdevice.setUniqueId(str, 16);
+
+    // Set other device properties
+    m_HAdevice.setName("Solar Controller Test 1");
+    m_HAdevice.setModel("SCTest1");
+    m_HAdevice.setSoftwareVersion("1.0.0");
+    m_HAdevice.setAvailability(true);
+    m_HAdevice.setManufacturer("DIY");
+    */
+
+    // MQTT broker connection (use your data here)
+    //m_mqtt.begin(HA_MQTT_BROKER, HA_MQTT_PORT, HA_MQTT_USER, HA_MQTT_PASSWORD);
+
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+    IPAddress ipAddress;
+    if (ipAddress.fromString(_mqttSettings.MQTTServer().c_str()))
+    {
+        // MQTT broker connection using IP address
+        _mqtt.begin(ipAddress, _mqttSettings.MQTTPort(),
+            _mqttSettings.MQTTUser().c_str(), _mqttSettings.MQTTPassword().c_str());
+        IOTLOGINFO("MQTT connecting using IP address");
+    }
+    else
+    {
+        // MQTT broker connection using server name
+        _mqtt.begin(_mqttSettings.MQTTServer().c_str(), _mqttSettings.MQTTPort(),
+            _mqttSettings.MQTTUser().c_str(), _mqttSettings.MQTTPassword().c_str());
+        IOTLOGINFO("MQTT connecting using server name");
+    }
+#endif
+
+    /*
+    _webServer.on("/", HTTP_GET, [this](AsyncWebServerRequest *request) {
+        String str(F("Hi! This is ElegantOTA AsyncDemo.\r\n"));
+        str += F("Version: ");
+        str += FPSTR(this->_pIoTDevice->deviceProperties().versionString);
+        request->send(200, "text/plain", str);
+    });
+    */
+
+    _pIoTDevice->onAddConfigRoutes(_webServer);
+    registerCommonRoutes();
+    registerRootHandler(ON_STA_FILTER);
+    registerSystemEventCallbacks();
+
+    _pWiFiManager->handleSTA();
+
+    _webServer.on("/api/appsave", HTTP_POST, [this](AsyncWebServerRequest *request) {
+        if (request->hasArg("temp_unit"))
+        {
+            const String unit = request->arg("temp_unit");
+            _appSettings.setTemperatureInCelsius(unit != "F");
+            if (_appSettings.isDirty())
+            {
+                _appSettings.save();
+                IOTLOGINFO1(F("Temperature unit saved: "), unit);
+                // Web handler context: deliver from loop()
+                _systemEvents.push(settingsChangedEvent(_appSettings));
+            }
+        }
+        ESPAsync_WiFiManagerUtils::responseApplJson(request, String(F("{\"result\":\"ok\"}")));
+    });
+
+    /*
+    ElegantOTA.begin(&_webServer);    // Start ElegantOTA
+    // ElegantOTA callbacks
+    ElegantOTA.onStart([]() {
+        // Log when OTA has started
+        Serial.println("OTA update started!");
+        // <Add your own code here>
+    });
+    ElegantOTA.onProgress([](size_t current, size_t final) {
+        // Log every 1 second
+        if (millis() - ota_progress_millis > 1000) {
+            ota_progress_millis = millis();
+            Serial.printf("OTA Progress Current: %u bytes, Final: %u bytes\n", current, final);
+        }
+    });
+    ElegantOTA.onEnd([](bool success) {
+        // Log when OTA has finished
+        if (success) {
+            Serial.println("OTA update finished successfully!");
+        } else {
+            Serial.println("There was an error during OTA update!");
+        }
+        // <Add your own code here>
+    });
+    */
+
+    _webServer.begin();
+}
+
+void IoTApplication::advanceBootState()
+{
+    switch (_bootState)
+    {
+        case BootState::WIFI_CONNECTING:
+            if (WiFi.status() == WL_CONNECTED)
+            {
+                IOTLOGINFO1(F("WiFi connected [ms]: "), millis() - _wifiBeginMs);
+                IOTLOGDEBUG1(F("IP:"), WiFi.localIP());
+                _bootState = BootState::NETWORK_START;
+            }
+            else if (millis() - _wifiBeginMs >= WIFI_CONNECT_TIMEOUT_MS)
+            {
+                // Same as the blocking path: carry on, the SDK keeps reconnecting.
+                IOTLOGWARN(F("WiFi not connected, starting network services anyway"));
+                _bootState = BootState::NETWORK_START;
+            }
+            break;
+
+        case BootState::NETWORK_START:
+            startNetworkServices();
+            _bootState = BootState::TIME_SYNC;
+            break;
+
+        case BootState::TIME_SYNC:
+            setupTime();
+            _bootState = BootState::RUNNING;
+            break;
+
+        case BootState::RUNNING:
+            break;
+    }
+}
+
 void IoTApplication::loop()
 {
+    _wifiConnection.loop();
+    dispatchSystemEvents();
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+    bool statusChanged = false;
+    _commandMailbox.process([this, &statusChanged](const char* uid, bool state) {
+        const bool handled = _pIoTDevice->dispatchWebCommand(uid, state);
+        statusChanged |= handled;
+        return handled;
+    });
+#endif
+    advanceBootState();
+
     _pWiFiManager->loop();
     _pIoTDevice->preLoop();
 
 #ifdef WM_SUPPORT_HOME_ASSISTANT
     if (_bUsingWiFi)
     {
+        // Read a burst of inbound packets in one pass so switch commands coalesce
         _mqtt.loop();
+        for (uint8_t i = 1; i < IOT_MQTT_INBOUND_BATCH && _wifiClient.available() > 0; ++i)
+        {
+            _mqtt.loop();
+        }
+    }
+    statusChanged |= _pIoTDevice->pollComponents();
+    if (statusChanged)
+    {
+        // Web toggles and /api/events must not wait for the next update cycle
+        _pIoTDevice->enableStatusDelta(_statusStream.hasClients());
+        _pIoTDevice->refreshStatusSnapshot();
+        publishStatusDelta();
     }
 #endif
 
+    if (_bootState == BootState::RUNNING && _bUsingWiFi)
+    {
+        updateTime();
+    }
+
     update();
 
     _pIoTDevice->postLoop();
+
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+    if (_dutyCycle.enabled())
+    {
+        runDutyCycle();
+        return;
+    }
+#endif
+
+    idleUntilNextDeadline();
+}
+
+void IoTApplication::idleUntilNextDeadline()
+{
+    if (_idle.policy() == IoTIdleScheduler::Policy::NONE || _bootState != BootState::RUNNING)
+    {
+        return;
+    }
+#ifdef _IOT_REAL_TIME
+    if (_ntpClient.busy())
+    {
+        return; // the reply is timestamped in loop(), keep the RTT exact
+    }
+#endif
+
+    IoTIdleScheduler::clearWake();
+    const uint32_t sinceUpdate = millis() - _lastUpdateMs;
+    uint32_t ms = sinceUpdate >= AUTOMATIC_UPDATE_MS ? 0 : AUTOMATIC_UPDATE_MS - sinceUpdate;
+    const uint32_t deviceMs = _pIoTDevice->msUntilNextDeadline();
+    if (deviceMs < ms)
+    {
+        ms = deviceMs;
+    }
+
+    _idle.idle(ms, [this]() {
+        return !_systemEvents.empty()
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+            || !_commandMailbox.empty()
+            || (_bUsingWiFi && _wifiClient.available() > 0)
+#endif
+            ;
+    });
 }
 
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+void IoTApplication::runDutyCycle()
+{
+    if (!_dutyPublished && _bootState == BootState::RUNNING && _mqtt.isConnected())
+    {
+        _dutyCycle.publish(*_pIoTDevice);
+        _dutyPublished   = true;
+        _dutyPublishedMs = millis();
+    }
+
+    // Sleep once the publish had time to leave, or give up (values stay
+    // unretained and are sent on the next wake)
+    if ((_dutyPublished && millis() - _dutyPublishedMs >= IoTDutyCycle::FLUSH_MS) ||
+        millis() >= IoTDutyCycle::MAX_AWAKE_MS)
+    {
+        _dutyCycle.sleep(true);
+    }
+}
+#endif
+
 void IoTApplication::update(bool bForceUpdate)
 {
 #ifdef WM_SUPPORT_HOME_ASSISTANT
@@ -398,7 +719,32 @@ void IoTApplication::update(bool bForceUpdate)
                 ? IoTSystemEvent::Type::MQTT_CONNECTED
                 : IoTSystemEvent::Type::MQTT_DISCONNECTED;
             _pIoTDevice->onSystemEvent(e);
+
+            // Publish right away instead of waiting for the next timer tick.
+            if (mqttNowConnected)
+            {
+                bForceUpdate = true;
+            }
+        }
+    }
+#endif
+
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+    if (_dutyCycle.enabled())
+    {
+        return; // sampled once per wake in setup(), published by runDutyCycle()
+    }
+#endif
+
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+    if (_pIoTDevice->componentUpdatePending())
+    {
+        _bPublishForced |= bForceUpdate;
+        if (_pIoTDevice->collectComponents())
+        {
+            publishComponentUpdate();
         }
+        return;
     }
 #endif
 
@@ -407,35 +753,52 @@ void IoTApplication::update(bool bForceUpdate)
 
     if (bForceUpdate)
         _automaticUpdateTimer.restart();
+    _lastUpdateMs = millis();
 
 #ifdef _IOT_REAL_TIME
-    if (_bUsingWiFi)
+    // Re-apply the drift-corrected NTP time (no network access here).
+    if (_ntpClient.isTimeSet())
     {
-        bool synced = false;
-        if (_bNeedsTimeSync)
-        {
-            synced = _ntpClient.forceUpdate();
-        }
-        else if (_ntpClient.isTimeSet())
-        {
-            synced = _ntpClient.update();
-        }
-        if (synced)
-        {
-            _bNeedsTimeSync = false;
-            Timezone tz(deviceProperties().dstStart, deviceProperties().stdStart);
-            setTime(tz.toLocal((time_t)_ntpClient.getEpochTime()));
-        }
+        setTime(_timezone.toLocal(_ntpClient.utcTime()));
     }
 #endif
 
 #ifdef WM_SUPPORT_HOME_ASSISTANT
-    _pIoTDevice->updateAllComponents(bForceUpdate);
-    if (_bUsingWiFi)
-        _pIoTDevice->publishAllComponents(bForceUpdate);
+    // Measurements still converting are collected by later loop() passes
+    _pIoTDevice->enableStatusDelta(_statusStream.hasClients());
+    _bPublishForced = bForceUpdate;
+    if (_pIoTDevice->startComponentUpdate(bForceUpdate))
+    {
+        publishComponentUpdate();
+    }
 #endif
 }
 
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+void IoTApplication::publishStatusDelta()
+{
+    if (!_pIoTDevice->statusDeltaJSON().isEmpty())
+    {
+        _statusStream.publishDelta(_pIoTDevice->statusSnapshot().version(),
+                                   _pIoTDevice->statusDeltaJSON());
+    }
+}
+
+void IoTApplication::publishComponentUpdate()
+{
+    publishStatusDelta();
+    if (_bUsingWiFi)
+    {
+        _pIoTDevice->publishAllComponents(_bPublishForced);
+        if (_firstPublishMs == 0 && _mqtt.isConnected())
+        {
+            _firstPublishMs = millis();
+            IOTLOGINFO1(F("Time to first publish [ms]: "), _firstPublishMs);
+        }
+    }
+}
+#endif
+
 
 bool IoTApplication::configure()
 {
@@ -467,8 +830,7 @@ bool IoTApplication::configure()
     _pWiFiManager->setConfigPortalTimeout(180); // 3 min
 
 #ifdef WM_SUPPORT_HOME_ASSISTANT
-    MQTTSettings mqttSettings;
-    mqttSettings.read();
+    MQTTSettings& mqttSettings = _mqttSettings;
     ESPAsync_WMParameter customMQTTserver("mqtt_server", "MQTT server", mqttSettings.MQTTServer().c_str(), 40);
     ESPAsync_WMParameter customMQTTport("mqtt_port", "MQTT port", String(mqttSettings.MQTTPort()).c_str(), 40);
     ESPAsync_WMParameter customMQTTuser("mqtt_user", "MQTT user", mqttSettings.MQTTUser().c_str(), 40);
@@ -528,21 +890,27 @@ bool IoTApplication::configure()
         IOTLOGDEBUG1(F("SSID: "), _pWiFiManager->getSSID());
         IOTLOGDEBUG1(F("PWD: "), _pWiFiManager->getPW());
         // Copy acquired settings to m_wifiSettings and save it
-        wifiSettings.setSSID(_pWiFiManager->getSSID());
-        wifiSettings.setPassword(_pWiFiManager->getPW());
+        wifiSettings.setSSID(_pWiFiManager->getSSID().c_str());
+        wifiSettings.setPassword(_pWiFiManager->getPW().c_str());
 
     #ifdef WM_SUPPORT_HOME_ASSISTANT
         mqttSettings.setMQTTServer(customMQTTserver.getValue());
         mqttSettings.setMQTTPort(String(customMQTTport.getValue()).toInt());
         mqttSettings.setMQTTUser(customMQTTuser.getValue());
         mqttSettings.setMQTTPassword(customMQTTpwd.getValue());
-        if (mqttSettings.isDirty()) mqttSettings.save();
+        if (mqttSettings.isDirty())
+        {
+            mqttSettings.save();
+            _pIoTDevice->onSystemEvent(settingsChangedEvent(mqttSettings));
+        }
     #endif
 
         if (wifiSettings.isDirty())
         {
             wifiSettings.save();
+            IoTWiFiQuickConnect::invalidate();
             IOTLOGDEBUG(F("WiFi configuration saved."));
+            _pIoTDevice->onSystemEvent(settingsChangedEvent(wifiSettings));
         }
 
         // Allow the device to read custom parameter values and persist them.
@@ -557,22 +925,23 @@ bool IoTApplication::configure()
 void IoTApplication::setupTime()
 {
 #ifdef _IOT_REAL_TIME
+    // The first sync is sent from loop(), see updateTime().
     _ntpClient.begin();
-    if (WiFi.status() == WL_CONNECTED)
+#endif
+}
+
+void IoTApplication::updateTime()
+{
+#ifdef _IOT_REAL_TIME
+    if (_bNeedsTimeSync)
     {
-        if (_ntpClient.forceUpdate())
-        {
-            Timezone tz(deviceProperties().dstStart, deviceProperties().stdStart);
-            setTime(tz.toLocal((time_t)_ntpClient.getEpochTime()));
-        }
-        else
-        {
-            _bNeedsTimeSync = true;
-        }
+        _bNeedsTimeSync = false;
+        _ntpClient.requestSync();
     }
-    else
+
+    if (_ntpClient.loop())
     {
-        _bNeedsTimeSync = true;
+        setTime(_timezone.toLocal(_ntpClient.utcTime()));
     }
 #endif
 }
@@ -585,13 +954,20 @@ time_t IoTApplication::NTPsyncProvider()
 
 time_t IoTApplication::UTCTime()
 {
+#ifdef _IOT_REAL_TIME
+    if (_ntpClient.isTimeSet())
+    {
+        return _ntpClient.utcTime();
+    }
+#endif
     return now();
 }
 
 time_t IoTApplication::localTime()
 {
 #ifdef _IOT_REAL_TIME
-    return now();
+    // Cached offset: one comparison and an addition until the next DST transition.
+    return _ntpClient.isTimeSet() ? _timezone.toLocal(_ntpClient.utcTime()) : now();
 #else
     return 0;
 #endif
@@ -633,20 +1009,41 @@ bool IoTApplication::handleCustomSystemQuery(AsyncWebServerRequest *request)
         String dx = request->arg("dx");
         if(dx == "fwinfo")
         {
-            auto pDevProp = _pIoTDevice->deviceProperties();
+            const DeviceProperties& devProp = _pIoTDevice->deviceProperties();
             jsonStr = JSONUtils::EncloseArray(
-                JSONUtils::NameValueRow(F("Firmware version"), pDevProp.versionString, true) +
-                JSONUtils::NameValueRow(F("Chip name"), pDevProp.chipName) +
-                JSONUtils::NameValueRow(F("Device name"), pDevProp.deviceName) +
-                JSONUtils::NameValueRow(F("Model"), pDevProp.deviceModel) +
-                JSONUtils::NameValueRow(F("Manutacturer"), pDevProp.manufacturer) +
-                JSONUtils::NameValueRow(F("Hardware ID"), pDevProp.hardwareId));
+                JSONUtils::NameValueRow(F("Firmware version"), FPSTR(devProp.versionString), true) +
+                JSONUtils::NameValueRow(F("Chip name"), FPSTR(devProp.chipName)) +
+                JSONUtils::NameValueRow(F("Device name"), FPSTR(devProp.deviceName)) +
+                JSONUtils::NameValueRow(F("Model"), FPSTR(devProp.deviceModel)) +
+                JSONUtils::NameValueRow(F("Manutacturer"), FPSTR(devProp.manufacturer)) +
+                JSONUtils::NameValueRow(F("Hardware ID"), FPSTR(devProp.hardwareId)) +
+                JSONUtils::NameValueRow(F("WiFi connect [ms]"),
+                    String(_wifiConnection.quickConnect().connectDurationMs(_wifiConnection.quickConnect().path())) + F(" (") +
+                    IoTWiFiQuickConnect::pathName(_wifiConnection.quickConnect().path()) + F(")"))
+                + JSONUtils::NameValueRow(F("System events dropped"), String(_systemEvents.overflows()))
+                + JSONUtils::NameValueRow(F("HTTP rejected busy / low heap"),
+                    String(_httpAdmission.rejectedBusy()) + F(" / ") + String(_httpAdmission.rejectedHeap()))
+                + JSONUtils::NameValueRow(F("Idle [%]"), String(_idle.idlePercent()))
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+                + JSONUtils::NameValueRow(F("Time to first publish [ms]"), String(_firstPublishMs))
+                + JSONUtils::NameValueRow(F("Status snapshot bytes / failed"),
+                    String(_pIoTDevice->statusSnapshot().capacity()) + F(" / ")
+                    + String(_pIoTDevice->statusSnapshot().failed()))
+                + JSONUtils::NameValueRow(F("Status stream resyncs / refused"),
+                    String(_statusStream.resyncs()) + F(" / ") + String(_statusStream.rejected()))
+                + JSONUtils::NameValueRow(F("Switch publishes sent / skipped"),
+                    String(IoTHASwitchWrapper::publishedCount()) + F(" / ") + String(IoTHASwitchWrapper::skippedCount()))
+                + JSONUtils::NameValueRow(F("Switch commands received / superseded / confirmed"),
+                    String(IoTHASwitchWrapper::commandsReceivedCount()) + F(" / ")
+                    + String(IoTHASwitchWrapper::commandsSupersededCount()) + F(" / ")
+                    + String(IoTHASwitchWrapper::commandsConfirmedCount()))
+#endif
+                );
         }
         else if(dx == "hwid")
         {
-            auto pDevProp = _pIoTDevice->deviceProperties();
             jsonStr = JSONUtils::EncloseObject(
-                JSONUtils::Pair(F("hwid"), pDevProp.hardwareId, true));
+                JSONUtils::Pair(F("hwid"), FPSTR(_pIoTDevice->deviceProperties().hardwareId), true));
         }
         else if(dx=="wifi")
         {
@@ -655,17 +1052,27 @@ bool IoTApplication::handleCustomSystemQuery(AsyncWebServerRequest *request)
             wifi2.read();
 
             jsonStr = JSONUtils::EncloseObject(
-                JSONUtils::Pair(F("ssid1"), wifi1.SSID(), true) +
-                JSONUtils::Pair(F("pwd1"),  wifi1.password()) +
-                JSONUtils::Pair(F("staticip1"),     wifi1.staticIP()) +
-                JSONUtils::Pair(F("staticgw1"),     wifi1.staticGateway()) +
-                JSONUtils::Pair(F("staticsubnet1"), wifi1.staticSubnet()) +
-                JSONUtils::Pair(F("ssid2"), wifi2.SSID()) +
-                JSONUtils::Pair(F("pwd2"),  wifi2.password()) +
-                JSONUtils::Pair(F("staticip2"),     wifi2.staticIP()) +
-                JSONUtils::Pair(F("staticgw2"),     wifi2.staticGateway()) +
-                JSONUtils::Pair(F("staticsubnet2"), wifi2.staticSubnet()));
+                JSONUtils::Pair(F("ssid1"), wifi1.SSID().c_str(), true) +
+                JSONUtils::Pair(F("pwd1"),  wifi1.password().c_str()) +
+                JSONUtils::Pair(F("staticip1"),     wifi1.staticIP().c_str()) +
+                JSONUtils::Pair(F("staticgw1"),     wifi1.staticGateway().c_str()) +
+                JSONUtils::Pair(F("staticsubnet1"), wifi1.staticSubnet().c_str()) +
+                JSONUtils::Pair(F("ssid2"), wifi2.SSID().c_str()) +
+                JSONUtils::Pair(F("pwd2"),  wifi2.password().c_str()) +
+                JSONUtils::Pair(F("staticip2"),     wifi2.staticIP().c_str()) +
+                JSONUtils::Pair(F("staticgw2"),     wifi2.staticGateway().c_str()) +
+                JSONUtils::Pair(F("staticsubnet2"), wifi2.staticSubnet().c_str()));
         }
+        else if(dx=="wifistats")
+        {
+            jsonStr = JSONUtils::EncloseArray(_wifiConnection.statusJSON());
+        }
+    #ifdef _IOT_REAL_TIME
+        else if(dx=="ntpstats")
+        {
+            jsonStr = JSONUtils::EncloseArray(_ntpClient.statusJSON());
+        }
+    #endif
     #ifdef WM_SUPPORT_HOME_ASSISTANT
         else if(dx=="mqtt")
         {
@@ -673,10 +1080,10 @@ bool IoTApplication::handleCustomSystemQuery(AsyncWebServerRequest *request)
             mqttSettings.read();
 
             jsonStr = JSONUtils::EncloseObject(
-                JSONUtils::Pair(F("host"), mqttSettings.MQTTServer(), true) +
+                JSONUtils::Pair(F("host"), mqttSettings.MQTTServer().c_str(), true) +
                 JSONUtils::Pair(F("port"), mqttSettings.MQTTPort()) +
-                JSONUtils::Pair(F("user"), mqttSettings.MQTTUser()) +
-                JSONUtils::Pair(F("pwd"),  mqttSettings.MQTTPassword()));
+                JSONUtils::Pair(F("user"), mqttSettings.MQTTUser().c_str()) +
+                JSONUtils::Pair(F("pwd"),  mqttSettings.MQTTPassword().c_str()));
         }
     #endif // WM_SUPPORT_HOME_ASSISTANT
         else if(dx=="appsettings")
@@ -690,6 +1097,10 @@ bool IoTApplication::handleCustomSystemQuery(AsyncWebServerRequest *request)
         {
             jsonStr = _pIoTDevice->allComponentsStatusJSON();
         }
+        else if(dx=="dutycycle")
+        {
+            jsonStr = _dutyCycle.statusJSON();
+        }
     #endif
     }
 
@@ -31,8 +31,6 @@
 #endif
 */
 
-#include <NTPClient.h>
-#include <WiFiUdp.h>
 #include <Timezone.h>
 #include <ESPAsyncWebServer.h>
 #include <ESPAsyncDNSServer.h>
@@ -41,6 +39,16 @@
 #include "IoTDebug.h"
 #include "Timer.h"
 #include "AppSettings.h"
+#include "MQTTSettings.h"
+#include "IoTWiFiConnectionManager.h"
+#include "IoTNtpClient.h"
+#include "IoTTimezoneCache.h"
+#include "IoTSystemEventQueue.h"
+#include "IoTCommandMailbox.h"
+#include "IoTStatusStream.h"
+#include "IoTHttpAdmission.h"
+#include "IoTDutyCycle.h"
+#include "IoTIdleScheduler.h"
 #include "ESPAsync_WiFiManagerUtils.h"
 
 //#define MAGIC_PREFIX "\xcc\x80\xc1\xca\x6e\xf3\x49\x7f\xa7\x26"
@@ -68,6 +76,44 @@ public:
      */
     virtual void loop();
 
+    /**
+     * @brief Enable fast-boot mode. Call before setup().
+     *        In fast-boot mode setup() skips the fixed start-up delays and
+     *        returns right after WiFi.begin(); loop() then finishes WiFi
+     *        association, MQTT start, web server start and time sync.
+     */
+    void setFastBoot(bool enable) { _bFastBoot = enable; }
+
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+    /**
+     * @brief Enable deep-sleep duty cycle for battery devices. Call before setup().
+     *        Every periodMs the device wakes, samples all components and only
+     *        connects to publish the ones that changed (all of them every
+     *        heartbeatCycles wakes), then deep sleeps again. Implies fast boot.
+     *        See IoTDutyCycle.
+     */
+    void setDutyCycle(uint32_t periodMs, uint16_t heartbeatCycles = 12)
+    {
+        _dutyCycle.begin(periodMs, heartbeatCycles);
+        _bFastBoot = true;
+    }
+#endif
+
+    /**
+     * @brief Sleep in loop() until the next deadline (periodic update,
+     *        display, IoTDevice::msUntilNextDeadline()) instead of spinning.
+     *        Queued web commands, system events and MQTT data end the sleep
+     *        within IoTIdleScheduler::POLL_MS. MODEM_SLEEP/LIGHT_SLEEP also
+     *        power-save the radio. Call before setup(). See IoTIdleScheduler.
+     */
+    void setIdlePolicy(IoTIdleScheduler::Policy policy) { _idle.setPolicy(policy); }
+
+    /**
+     * @brief Milliseconds from boot to the first publish with MQTT connected,
+     *        0 while nothing has been published yet.
+     */
+    unsigned long timeToFirstPublishMs() const { return _firstPublishMs; }
+
     /**
      * @brief update state machine if update time has elapsed and
      *        update screen.
@@ -107,11 +153,33 @@ public:
 
 
 private:
+    /**
+     * @brief Start-up phases driven from loop() in fast-boot mode.
+     */
+    enum class BootState : uint8_t
+    {
+        WIFI_CONNECTING,
+        NETWORK_START,
+        TIME_SYNC,
+        RUNNING,
+    };
+
     /**
      * @brief Creates WiFi AP to configure WiFi and MQTT
      */
     bool configure();
 
+    /**
+     * @brief Begin MQTT, register STA routes and start the web server.
+     */
+    void startNetworkServices();
+
+    /**
+     * @brief Advance the fast-boot state machine by at most one phase.
+     *        Never blocks.
+     */
+    void advanceBootState();
+
     /**
      * @brief Register common static asset routes (e.g. /hw-status.js).
      *        Called from both the STA and AP setup paths.
@@ -144,6 +212,11 @@ private:
      */
     void setupTime();
 
+    /**
+     * @brief Drive the NTP exchange and apply new/drift-corrected time
+     */
+    void updateTime();
+
     /**
      * @brief get WiFi status character to show on LCD
      */
@@ -156,6 +229,35 @@ private:
      */
     void registerSystemEventCallbacks();
 
+    /**
+     * @brief Deliver system events queued by callbacks, called from loop().
+     */
+    void dispatchSystemEvents();
+
+    /**
+     * @brief Idle until the earliest deadline if the idle policy allows it.
+     *        Called at the end of loop().
+     */
+    void idleUntilNextDeadline();
+
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+    /**
+     * @brief Push a completed component update to SSE clients and MQTT.
+     */
+    void publishComponentUpdate();
+
+    /**
+     * @brief Push the status delta of the last snapshot to SSE clients.
+     */
+    void publishStatusDelta();
+
+    /**
+     * @brief Duty-cycle mode: publish once MQTT is up, then deep sleep.
+     *        Called from loop().
+     */
+    void runDutyCycle();
+#endif
+
 private:
 
     /**
@@ -186,13 +288,24 @@ private:
      */
     AsyncWebServer _webServer;
 
+    /**
+     * @brief Rejects requests with 503 when busy or low on heap; first handler
+     *        of _webServer
+     */
+    IoTHttpAdmission _httpAdmission;
+
     /**
      * @brief DNS server
      */
     AsyncDNSServer _dnsServer;
 
     // Timers
+    static constexpr uint32_t AUTOMATIC_UPDATE_MS = 15 * 1000;
     Timer _automaticUpdateTimer;
+    uint32_t _lastUpdateMs = 0;
+
+    // Idle between loop() iterations, disabled unless setIdlePolicy() was called
+    IoTIdleScheduler _idle;
 
     /**
      * @brief Update timer for BME device
@@ -216,9 +329,28 @@ private:
     // Flag to publish device to HA
     bool _bPublishDeviceToHA = false;
 
+    // Fast-boot mode and its current phase (RUNNING when bring-up is done)
+    bool _bFastBoot = false;
+    BootState _bootState = BootState::RUNNING;
+
+    // millis() when WiFi.begin() was called
+    unsigned long _wifiBeginMs = 0;
+
+    // Events from WiFi/OTA callbacks, delivered in loop()
+    IoTSystemEventQueue _systemEvents;
+
+    // AP selection/failover over WIFI and WIFI2, with the RTC quick-connect path
+    IoTWiFiConnectionManager _wifiConnection;
+
+    // millis() of the first publish with MQTT connected (0 = not yet)
+    unsigned long _firstPublishMs = 0;
+
+    // Give up waiting for WiFi during bring-up and start services anyway
+    static constexpr unsigned long WIFI_CONNECT_TIMEOUT_MS = 10000UL;
+
 #ifdef _IOT_REAL_TIME
-    WiFiUDP   _ntpUDP;
-    NTPClient _ntpClient;
+    IoTNtpClient _ntpClient;
+    IoTTimezoneCache _timezone;
     bool _bNeedsTimeSync = false;
 #endif
 
@@ -231,6 +363,29 @@ private:
 #ifdef WM_SUPPORT_HOME_ASSISTANT
     bool _mqttWasConnected = false;
 
+    /**
+     * @brief MQTT settings. Kept for the application lifetime because
+     *        HAMqtt::begin() stores the server and credential pointers.
+     */
+    MQTTSettings _mqttSettings;
+
+    // Web commands, applied in loop()
+    IoTCommandMailbox _commandMailbox;
+
+    // Fail a queued web command whose response is still pending after this
+    static constexpr uint32_t COMMAND_TIMEOUT_MS = 5000;
+
+    // Force flag of the component update in progress, see update()
+    bool _bPublishForced = false;
+
+    // Status deltas pushed to web clients (Server-Sent Events)
+    IoTStatusStream _statusStream;
+
+    // Deep-sleep duty cycle, disabled unless setDutyCycle() was called
+    IoTDutyCycle  _dutyCycle;
+    bool          _dutyPublished   = false;
+    unsigned long _dutyPublishedMs = 0;
+
     /**
      * @brief Wifi client for ArduinoHA
      */
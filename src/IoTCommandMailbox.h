@@ -0,0 +1,236 @@
+/*
+  IoTCommandMailbox.h - Hand-off of component commands from web handlers to loop().
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <string.h>
+#include "IoTSpscQueue.h"
+
+#ifndef IOT_COMMAND_MAILBOX_SIZE
+    #define IOT_COMMAND_MAILBOX_SIZE 8
+#endif
+
+#ifndef IOT_COMMAND_BATCH_MAX
+    #define IOT_COMMAND_BATCH_MAX 8
+#endif
+
+/**
+ * @brief Bounded lock-free mailbox of on/off commands addressed by entity uid.
+ *
+ * Web handlers (async TCP context) post() a command or a Batch of commands and
+ * get a request id; loop() applies queued commands via process(); the handler
+ * then polls result(id) / batchResult(id) to complete its response. Components
+ * are therefore only touched from loop(), never concurrently with
+ * update()/publish or the MQTT client.
+ *
+ * A batch is queued in one step, so process() always applies all of its items
+ * in the same loop() pass.
+ *
+ * Single producer (the async web server) and single consumer (loop()).
+ * Results are kept in a table of RESULT_SLOTS entries indexed by id; each
+ * entry is guarded by its id (written last, cleared first), so a reader never
+ * sees a result belonging to another request.
+ */
+class IoTCommandMailbox
+{
+public:
+    static constexpr size_t  SIZE         = IOT_COMMAND_MAILBOX_SIZE;
+    static constexpr size_t  UID_SIZE     = 32;
+    static constexpr uint8_t BATCH_MAX    = IOT_COMMAND_BATCH_MAX;
+    static constexpr uint8_t RESULT_SLOTS = 16;
+
+    static_assert(BATCH_MAX <= SIZE && BATCH_MAX <= 32,
+                  "IOT_COMMAND_BATCH_MAX must fit into the mailbox and a 32-bit mask");
+
+    enum class Result : uint8_t
+    {
+        PENDING,    ///< not applied yet (or result slot already reused)
+        APPLIED,
+        NOT_FOUND,  ///< no component accepted the uid
+    };
+
+private:
+    struct Command
+    {
+        uint32_t requestId;
+        char     uid[UID_SIZE];
+        bool     state;
+        uint8_t  index;     ///< position within its batch
+        bool     last;      ///< last command of its batch
+    };
+
+public:
+    /**
+     * @brief Up to BATCH_MAX commands applied together.
+     */
+    class Batch
+    {
+    public:
+        /**
+         * @return false if the batch is full or uid is too long
+         */
+        bool add(const char* uid, size_t uidLen, bool state)
+        {
+            if (_count >= BATCH_MAX || uidLen >= UID_SIZE)
+            {
+                return false;
+            }
+            Command& cmd = _items[_count];
+            memcpy(cmd.uid, uid, uidLen);
+            cmd.uid[uidLen] = '\0';
+            cmd.state = state;
+            cmd.index = _count;
+            cmd.last  = false;
+            ++_count;
+            return true;
+        }
+
+        bool add(const char* uid, bool state) { return add(uid, strlen(uid), state); }
+
+        uint8_t size() const { return _count; }
+
+        /** @brief uid of item i, as added. */
+        const char* uid(uint8_t i) const { return _items[i].uid; }
+
+    private:
+        friend class IoTCommandMailbox;
+        Command _items[BATCH_MAX];
+        uint8_t _count = 0;
+    };
+
+    /**
+     * @brief Queue a command (producer side).
+     * @return request id, 0 if the mailbox is full or uid is too long
+     */
+    uint32_t post(const char* uid, bool state)
+    {
+        Batch batch;
+        if (!batch.add(uid, state))
+        {
+            return 0;
+        }
+        return post(batch);
+    }
+
+    /**
+     * @brief Queue all commands of batch under one request id (producer side).
+     * @return request id, 0 if the batch is empty or does not fit
+     */
+    uint32_t post(Batch& batch)
+    {
+        if (batch._count == 0)
+        {
+            return 0;
+        }
+
+        if (++_lastId == 0)
+        {
+            _lastId = 1;
+        }
+        for (uint8_t i = 0; i < batch._count; ++i)
+        {
+            batch._items[i].requestId = _lastId;
+            batch._items[i].last      = i + 1 == batch._count;
+        }
+
+        if (!_queue.push(batch._items, batch._count))
+        {
+            _rejected.store(_rejected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return 0;
+        }
+        return _lastId;
+    }
+
+    /**
+     * @brief Apply all queued commands (consumer side, loop()).
+     * @param apply - callable bool(const char* uid, bool state), true if handled
+     */
+    template<typename Apply>
+    void process(Apply&& apply)
+    {
+        Command cmd;
+        uint32_t appliedMask = 0;
+        while (_queue.pop(cmd))
+        {
+            if (apply(cmd.uid, cmd.state))
+            {
+                appliedMask |= 1UL << cmd.index;
+            }
+            if (cmd.last)
+            {
+                ResultSlot& slot = _results[cmd.requestId % RESULT_SLOTS];
+                slot.id.store(0, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                slot.appliedMask.store(appliedMask, std::memory_order_relaxed);
+                slot.id.store(cmd.requestId, std::memory_order_release);
+                appliedMask = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief Outcome of a single-command request id (any context).
+     */
+    Result result(uint32_t requestId) const
+    {
+        uint32_t appliedMask;
+        if (!batchResult(requestId, appliedMask))
+        {
+            return Result::PENDING;
+        }
+        return (appliedMask & 1) ? Result::APPLIED : Result::NOT_FOUND;
+    }
+
+    /**
+     * @brief Outcome of a batch request id (any context).
+     * @param appliedMask - bit i set if item i was handled by a component
+     * @return false while pending (or result slot already reused)
+     */
+    bool batchResult(uint32_t requestId, uint32_t& appliedMask) const
+    {
+        const ResultSlot& slot = _results[requestId % RESULT_SLOTS];
+        if (slot.id.load(std::memory_order_acquire) != requestId)
+        {
+            return false;
+        }
+        appliedMask = slot.appliedMask.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.id.load(std::memory_order_relaxed) == requestId;
+    }
+
+    /** @brief True if no command is queued (consumer side). */
+    bool empty() const { return _queue.empty(); }
+
+    /** @brief Number of requests rejected because the mailbox was full. */
+    uint32_t rejected() const { return _rejected.load(std::memory_order_relaxed); }
+
+private:
+    struct ResultSlot
+    {
+        std::atomic<uint32_t> id{0};
+        std::atomic<uint32_t> appliedMask{0};
+    };
+
+    IoTSpscQueue<Command, SIZE> _queue;
+    ResultSlot _results[RESULT_SLOTS];
+
+    // Producer side only
+    uint32_t _lastId = 0;
+    std::atomic<uint32_t> _rejected{0};
+};
@@ -21,6 +21,10 @@
 #include "IoTApplication.h"
 #include "IoTDevice.h"
 #include "IoTDebug.h"
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+    #include <utils/HADictionary.h>
+    #include <utils/HASerializer.h>
+#endif
 
 IoTDevice::IoTDevice(const DeviceProperties& properties) :
     _properties(properties)
@@ -36,18 +40,15 @@ void IoTDevice::preSetup()
     WiFi.macAddress(mac);
     _device.setUniqueId(mac, sizeof(mac));
 
-    // DeviceProperties strings are in PROGMEM — copy to static RAM buffers for the HA library.
-    static char s_name[32], s_model[32], s_manufacturer[32], s_version[16];
-    strncpy_P(s_name,         _properties.deviceName,    sizeof(s_name)         - 1);
-    strncpy_P(s_model,        _properties.deviceModel,   sizeof(s_model)        - 1);
-    strncpy_P(s_manufacturer, _properties.manufacturer,  sizeof(s_manufacturer) - 1);
-    strncpy_P(s_version,      _properties.versionString, sizeof(s_version)      - 1);
-
-    _device.setName(s_name);
-    _device.setModel(s_model);
-    _device.setSoftwareVersion(s_version);
+    // DeviceProperties strings are in PROGMEM. HADevice's setters take RAM
+    // strings, so hand them to its serializer as flash values instead; the
+    // discovery payload then streams them from flash without a RAM copy.
+    HASerializer* serializer = const_cast<HASerializer*>(_device.getSerializer());
+    serializer->set(FPSTR(HANameProperty),            _properties.deviceName,    HASerializer::ProgmemPropertyValue);
+    serializer->set(FPSTR(HAModelProperty),           _properties.deviceModel,   HASerializer::ProgmemPropertyValue);
+    serializer->set(FPSTR(HASoftwareVersionProperty), _properties.versionString, HASerializer::ProgmemPropertyValue);
+    serializer->set(FPSTR(HAManufacturerProperty),    _properties.manufacturer,  HASerializer::ProgmemPropertyValue);
     _device.setAvailability(true);
-    _device.setManufacturer(s_manufacturer);
 
     forEachComponent(&IoTHADeviceWrapperBase::begin);
 #endif
@@ -55,17 +56,108 @@ void IoTDevice::preSetup()
 
 #ifdef WM_SUPPORT_HOME_ASSISTANT
 
+namespace
+{
+    // FNV-1a, used to detect status changes between update cycles
+    uint32_t fnv1a(const String& s)
+    {
+        uint32_t h = 2166136261UL;
+        for (size_t i = 0; i < s.length(); ++i)
+        {
+            h = (h ^ static_cast<uint8_t>(s[i])) * 16777619UL;
+        }
+        return h;
+    }
+}
+
 void IoTDevice::registerComponent(IoTHADeviceWrapperBase& component)
 {
     if (_componentCount < MAX_COMPONENTS)
+    {
         _components[_componentCount++] = &component;
+        if (component.systemEventMask())
+            _eventBus.subscribe(component, component.systemEventMask());
+    }
     else
         IOTLOGWARN(F("IoTDevice: MAX_COMPONENTS reached, component not registered"));
 }
 
 void IoTDevice::updateAllComponents(bool force)
 {
-    forEachComponent(&IoTHADeviceWrapperBase::update, force);
+    if (startComponentUpdate(force))
+    {
+        return;
+    }
+    while (!collectComponents())
+    {
+        delay(msUntilNextCollect());
+    }
+}
+
+bool IoTDevice::startComponentUpdate(bool force)
+{
+    _updateForce = force;
+    _pendingMask = 0;
+    for (uint8_t i = 0; i < _componentCount; ++i)
+    {
+        _readyAtMs[i] = millis() + _components[i]->startMeasurement(force);
+        _pendingMask |= 1UL << i;
+    }
+    return collectComponents();
+}
+
+bool IoTDevice::collectComponents()
+{
+    for (uint8_t i = 0; i < _componentCount; ++i)
+    {
+        const uint32_t bit = 1UL << i;
+        if (!(_pendingMask & bit) || static_cast<int32_t>(millis() - _readyAtMs[i]) < 0)
+        {
+            continue;
+        }
+        _pendingMask &= ~bit;
+
+        const bool failed = !_components[i]->collect(_updateForce);
+        if (failed != ((_faultMask & bit) != 0))
+        {
+            // Report only transitions: fault raised / cleared
+            _faultMask ^= bit;
+            IoTSystemEvent e;
+            e.type   = IoTSystemEvent::Type::SENSOR_FAULT;
+            e.flag   = failed;
+            e.arg1   = i;
+            e.source = _components[i];
+            onSystemEvent(e);
+        }
+    }
+    if (_pendingMask != 0)
+    {
+        return false;
+    }
+    publishStatusSnapshot();
+    return true;
+}
+
+uint32_t IoTDevice::msUntilNextCollect() const
+{
+    uint32_t ms = UINT32_MAX;
+    for (uint8_t i = 0; i < _componentCount; ++i)
+    {
+        if (!(_pendingMask & (1UL << i)))
+        {
+            continue;
+        }
+        const int32_t left = static_cast<int32_t>(_readyAtMs[i] - millis());
+        if (left <= 0)
+        {
+            return 0;
+        }
+        if (static_cast<uint32_t>(left) < ms)
+        {
+            ms = left;
+        }
+    }
+    return ms;
 }
 
 void IoTDevice::publishAllComponents(bool force)
@@ -75,18 +167,55 @@ void IoTDevice::publishAllComponents(bool force)
 
 String IoTDevice::allComponentsStatusJSON() const
 {
-    String result(F("["));
-    bool first = true;
+    String result;
+    if (!_statusSnapshot.read(result))
+    {
+        result = F("[]");
+    }
+    return result;
+}
+
+void IoTDevice::publishStatusSnapshot()
+{
+    _statusDelta = String();
+    String json;
+    json += '[';
     for (uint8_t i = 0; i < _componentCount; ++i)
     {
         String part = _components[i]->statusJSON();
+        const uint32_t hash = fnv1a(part);
+        if (hash != _statusHash[i])
+        {
+            _statusHash[i] = hash;
+            if (_statusDeltaEnabled && !part.isEmpty())
+            {
+                _statusDelta += _statusDelta.isEmpty() ? '[' : ',';
+                _statusDelta += part;
+            }
+        }
         if (part.isEmpty()) continue;
-        if (!first) result += ',';
-        result += part;
-        first = false;
+        if (json.length() > 1) json += ',';
+        json += part;
+    }
+    json += ']';
+    if (!_statusSnapshot.publish(json.c_str(), json.length()) && _statusSnapshot.failed() == 1)
+    {
+        IOTLOGWARN1(F("IoTDevice: no heap for the status snapshot, bytes: "), json.length());
+    }
+    if (!_statusDelta.isEmpty())
+    {
+        _statusDelta += ']';
     }
-    result += F("]");
-    return result;
+}
+
+bool IoTDevice::pollComponents()
+{
+    bool changed = false;
+    for (uint8_t i = 0; i < _componentCount; ++i)
+    {
+        changed |= _components[i]->poll();
+    }
+    return changed;
 }
 
 bool IoTDevice::dispatchWebCommand(const char* uid, bool state)
@@ -106,7 +235,11 @@ bool IoTDevice::dispatchWebCommand(const char* uid, bool state)
 void IoTDevice::registerPage(IoTDisplayPage& page)
 {
     if (_displayPageCount < MAX_DISPLAY_PAGES)
+    {
         _displayPages[_displayPageCount++] = &page;
+        if (page.systemEventMask())
+            _eventBus.subscribe(page, page.systemEventMask());
+    }
     else
         IOTLOGWARN(F("IoTDevice: MAX_DISPLAY_PAGES reached, page not registered"));
 }
@@ -129,6 +262,46 @@ void IoTDevice::tickDisplayPages()
     {
         _displayPageTimer.restart();
         _displayTimerReady = true;
+        _pageShownMs = millis();
     }
+    const uint8_t pageIndex = _currentPageIndex;
     onUpdateDisplay(*_pDisplay);
+    _lastRenderMs = millis();
+    if (_currentPageIndex != pageIndex)
+    {
+        _pageShownMs = _lastRenderMs;
+    }
+}
+
+uint32_t IoTDevice::msUntilNextDeadline() const
+{
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+    uint32_t collectMs = msUntilNextCollect();
+    for (uint8_t i = 0; i < _componentCount; ++i)
+    {
+        const uint32_t pollMs = _components[i]->msUntilNextPoll();
+        if (pollMs < collectMs)
+        {
+            collectMs = pollMs;
+        }
+    }
+#else
+    const uint32_t collectMs = UINT32_MAX;
+#endif
+    if (!_pDisplay || _displayFrozen || _displayPageCount == 0)
+    {
+        return collectMs;
+    }
+    const uint32_t now = millis();
+    const uint32_t sinceRender = now - _lastRenderMs;
+    uint32_t ms = sinceRender >= DISPLAY_REFRESH_MS ? 0 : DISPLAY_REFRESH_MS - sinceRender;
+
+    // Overridden onUpdateDisplay() may not cycle pages; then only the refresh counts
+    const uint32_t shown    = now - _pageShownMs;
+    const uint32_t duration = _displayPages[_currentPageIndex]->durationMs();
+    if (shown < duration && duration - shown < ms)
+    {
+        ms = duration - shown;
+    }
+    return collectMs < ms ? collectMs : ms;
 }
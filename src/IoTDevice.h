@@ -23,6 +23,7 @@
 #ifdef WM_SUPPORT_HOME_ASSISTANT
     #include <ArduinoHA.h> // Home Assistant
     #include "IoTHADeviceWrapperBase.h"
+    #include "IoTStatusSnapshot.h"
 #endif
 
 #include <Timezone.h> // Time zone
@@ -30,6 +31,7 @@
 #include "IoTTextDisplay.h"
 #include "IoTDisplayPage.h"
 #include "IoTSystemEvent.h"
+#include "IoTSystemEventBus.h"
 #include "Timer.h"
 
 // Forward declaration — avoids pulling AsyncWebServer into every TU that includes IoTDevice.h
@@ -298,6 +300,17 @@ class IoTDevice
         tickDisplayPages();
     }
 
+    /**
+     * @brief Time until loop() has work for this device [ms], used by the
+     *        idle policy (IoTApplication::setIdlePolicy()) to decide how long
+     *        it may sleep. The default covers display refresh and page
+     *        switching and returns UINT32_MAX without a running display.
+     *        Override when preLoop()/postLoop() poll hardware and combine
+     *        with the base result (it also covers pending
+     *        collectComponents()); return 0 to prevent idling.
+     */
+    virtual uint32_t msUntilNextDeadline() const;
+
 #ifdef WM_SUPPORT_HOME_ASSISTANT
     /**
      * @brief Get access to Home assistant MQTT device
@@ -308,27 +321,93 @@ class IoTDevice
     }
 
     /**
-     * @brief Call update(force) on every registered component in registration order.
+     * @brief Update every registered component and wait for the result.
      *        Drives hardware polling (e.g. temperature conversion) before publishing.
+     *        Runs startComponentUpdate() and waits until collectComponents()
+     *        completes, so it blocks for the longest conversion.
+     *        A component whose collect() starts/stops returning false raises a
+     *        SENSOR_FAULT event (flag = true/false).
      */
     void updateAllComponents(bool force = false);
 
+    /**
+     * @brief Start a split-phase update: call startMeasurement(force) on every
+     *        component, then collect those that are ready already.
+     * @return true if the update completed in this call (no component needs
+     *         to wait), as for collectComponents()
+     */
+    bool startComponentUpdate(bool force = false);
+
+    /**
+     * @brief Collect every component whose measurement is ready. When the last
+     *        one is collected the status snapshot is published.
+     *        Call from loop() while componentUpdatePending().
+     * @return true if the update has completed
+     */
+    bool collectComponents();
+
+    /** @brief True between startComponentUpdate() and its completion. */
+    bool componentUpdatePending() const { return _pendingMask != 0; }
+
+    /**
+     * @brief Call poll() on every registered component. Called from each
+     *        IoTApplication::loop() pass.
+     * @return true if any component reported a status change
+     */
+    bool pollComponents();
+
+    /**
+     * @brief Rebuild the status snapshot (and statusDeltaJSON()) outside an
+     *        update cycle, e.g. after a command changed a component.
+     */
+    void refreshStatusSnapshot() { publishStatusSnapshot(); }
+
     /**
      * @brief Call publishValue(force) on every registered component.
      */
     void publishAllComponents(bool force = false);
 
     /**
-     * @brief Assemble statusJSON() results from all components into a flat JSON array.
+     * @brief statusJSON() results of all components as a flat JSON array, taken
+     *        from the snapshot published by the last updateAllComponents().
+     *        Safe to call from web handlers: reads the snapshot without locks and
+     *        does not call into the components.
      *        Returns "[]" when no component has status to report.
      */
     String allComponentsStatusJSON() const;
 
+    /**
+     * @brief Snapshot behind allComponentsStatusJSON(); version() changes with
+     *        every update cycle.
+     */
+    const IoTStatusSnapshot& statusSnapshot() const { return _statusSnapshot; }
+
+    /**
+     * @brief Collect statusDeltaJSON() during updateAllComponents(). Off by
+     *        default; enable only while someone consumes the deltas.
+     */
+    void enableStatusDelta(bool enable) { _statusDeltaEnabled = enable; }
+
+    /**
+     * @brief JSON array of the statusJSON() objects that changed in the last
+     *        updateAllComponents(), or an empty string if none changed or
+     *        collection is disabled. loop() context only.
+     */
+    const String& statusDeltaJSON() const { return _statusDelta; }
+
     /**
      * @brief Dispatch a web UI command to the first component that claims uid.
+     *        Call from loop() only; web handlers go through IoTApplication's
+     *        command mailbox.
      * @return true if a component handled the command, false if uid was not found.
      */
     bool dispatchWebCommand(const char* uid, bool state);
+
+    /** @brief Number of registered components. */
+    uint8_t componentCount() const { return _componentCount; }
+
+    /** @brief Registered component i, 0 <= i < componentCount(). */
+    IoTHADeviceWrapperBase& component(uint8_t i) const { return *_components[i]; }
 #endif
 
     /**
@@ -363,16 +442,21 @@ class IoTDevice
             default:
                 break;
         }
-        if (_pDisplay)
-        {
-            _pDisplay->onSystemEvent(event);
-        }
+        _eventBus.publish(event);
     }
 
     /**
-     * @brief Get access to device properties
+     * @brief Bus delivering system events to subscribed listeners. The display,
+     *        registered pages and components are subscribed automatically with
+     *        their systemEventMask(); other listeners may subscribe in setup.
+     */
+    IoTSystemEventBus& eventBus() { return _eventBus; }
+
+    /**
+     * @brief Get access to device properties. The strings are PROGMEM
+     *        pointers: wrap them in FPSTR() to print or serialize them.
      */
-    const DeviceProperties& deviceProperties()
+    const DeviceProperties& deviceProperties() const
     {
         return _properties;
     }
@@ -399,7 +483,15 @@ protected:
     /**
      * @brief Register a display. Typically called from the derived class constructor.
      */
-    void setDisplay(IoTTextDisplay& display) { _pDisplay = &display; }
+    void setDisplay(IoTTextDisplay& display)
+    {
+        if (_pDisplay)
+        {
+            _eventBus.unsubscribe(*_pDisplay);
+        }
+        _pDisplay = &display;
+        _eventBus.subscribe(display, display.systemEventMask());
+    }
 
     /**
      * @brief Register a display page. Pages are shown in registration order.
@@ -455,11 +547,33 @@ private:
     static constexpr uint8_t MAX_COMPONENTS = IOT_MAX_COMPONENTS;
     IoTHADeviceWrapperBase* _components[MAX_COMPONENTS] = {};
     uint8_t _componentCount = 0;
+
+    // Bit i set while component i's update() fails (SENSOR_FAULT state)
+    static_assert(MAX_COMPONENTS <= 32, "IoTDevice fault mask holds 32 components");
+    uint32_t _faultMask = 0;
+
+    // Split-phase update: bit i set until component i is collected
+    uint32_t _pendingMask = 0;
+    uint32_t _readyAtMs[MAX_COMPONENTS] = {};
+    bool     _updateForce = false;
+
+    // Milliseconds until the next pending component is ready, UINT32_MAX if none
+    uint32_t msUntilNextCollect() const;
+
+    // Rebuild _statusSnapshot from all components (loop() context)
+    void publishStatusSnapshot();
+    IoTStatusSnapshot _statusSnapshot;
+    uint32_t _statusHash[MAX_COMPONENTS] = {};
+    String   _statusDelta;
+    bool     _statusDeltaEnabled = false;
 #endif
 
 private:
+    IoTSystemEventBus _eventBus;
+
     // Display / page cycling
     static constexpr uint8_t MAX_DISPLAY_PAGES = 6;
+    static constexpr uint32_t DISPLAY_REFRESH_MS = 1000; ///< re-render period when idling
     IoTTextDisplay*  _pDisplay            = nullptr;
     IoTDisplayPage*  _displayPages[MAX_DISPLAY_PAGES] = {};
     uint8_t          _displayPageCount    = 0;
@@ -467,6 +581,8 @@ private:
     Timer            _displayPageTimer{5000};
     bool             _displayTimerReady   = false;
     bool             _displayFrozen       = false;
+    uint32_t         _lastRenderMs        = 0;
+    uint32_t         _pageShownMs         = 0;
 
 
 };
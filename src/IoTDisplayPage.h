@@ -20,6 +20,7 @@
 #pragma once
 
 #include "IoTTextDisplay.h"
+#include "IoTSystemEventBus.h"
 
 /**
  * @brief Abstract base for a single display page.
@@ -28,8 +29,11 @@
  * Register pages with IoTDevice::registerPage(). The framework cycles through
  * registered pages automatically, calling render() on the active page at each
  * display refresh tick.
+ *
+ * A page that reacts to system events overrides onSystemEvent() and
+ * systemEventMask(); it is subscribed when registered.
  */
-class IoTDisplayPage
+class IoTDisplayPage : public IoTSystemEventListener
 {
 public:
     virtual ~IoTDisplayPage() = default;
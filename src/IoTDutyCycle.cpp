@@ -0,0 +1,144 @@
+/*
+  IoTDutyCycle.cpp - Deep-sleep duty cycle for battery powered devices.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+
+#include "IoTDutyCycle.h"
+#include "IoTWiFiQuickConnect.h"
+#include "IoTDebug.h"
+#include "JSONUtils.h"
+
+#if defined(ESP8266)
+    #include <ESP8266WiFi.h>
+#elif defined(ESP32)
+    #include <WiFi.h>
+    #include <esp_sleep.h>
+#endif
+
+void IoTDutyCycle::restore(uint8_t componentCount)
+{
+    Record r;
+    _valid = IoTRtcMemory::read(IoTRtcMemory::DUTY_CYCLE_BLOCK, &r, sizeof(r))
+        && r.magic == MAGIC
+        && r.checksum == IoTRtcMemory::checksum(&r.cycles, sizeof(r) - offsetof(Record, cycles))
+        && r.componentCount == componentCount;
+
+    if (_valid)
+    {
+        _record = r;
+    }
+    else
+    {
+        _record = {};
+        _record.componentCount = componentCount;
+    }
+    ++_record.cycles;
+    IOTLOGINFO2(F("Duty cycle wake: "), _record.cycles,
+                String(F(", last awake [ms]: ")) + _record.lastAwakeMs);
+}
+
+bool IoTDutyCycle::evaluate(const IoTDevice& device)
+{
+    _changedMask = 0;
+    for (uint8_t i = 0; i < device.componentCount() && i < MAX_RETAINED; ++i)
+    {
+        if (!_valid || device.component(i).changedSince(_record.retained[i]))
+        {
+            _changedMask |= 1UL << i;
+        }
+    }
+    _heartbeat = !_valid || _record.sincePublish + 1 >= _heartbeatCycles;
+    return _changedMask != 0 || _heartbeat;
+}
+
+void IoTDutyCycle::publish(IoTDevice& device)
+{
+    bool allSent = true;
+    for (uint8_t i = 0; i < device.componentCount() && i < MAX_RETAINED; ++i)
+    {
+        if (!_heartbeat && !(_changedMask & (1UL << i)))
+        {
+            continue;
+        }
+        IoTHADeviceWrapperBase& c = device.component(i);
+        if (c.publishValue(true))
+        {
+            _record.retained[i] = c.retainedValue();
+        }
+        else
+        {
+            allSent = false;
+        }
+    }
+    if (_heartbeat && allSent)
+    {
+        _record.sincePublish = 0;
+    }
+}
+
+void IoTDutyCycle::sleep(bool usedNetwork)
+{
+    const uint32_t awakeMs = millis();
+    if (!usedNetwork)
+    {
+        ++_record.skipped;
+    }
+    if (_record.sincePublish < 0xFFFF)
+    {
+        ++_record.sincePublish;
+    }
+    _record.lastAwakeMs = awakeMs;
+    _record.avgAwakeMs  = _record.avgAwakeMs == 0
+        ? awakeMs
+        : _record.avgAwakeMs - _record.avgAwakeMs / 8 + awakeMs / 8;
+    _record.magic    = MAGIC;
+    _record.checksum = IoTRtcMemory::checksum(&_record.cycles, sizeof(_record) - offsetof(Record, cycles));
+    IoTRtcMemory::write(IoTRtcMemory::DUTY_CYCLE_BLOCK, &_record, sizeof(_record));
+
+    uint64_t sleepUs = static_cast<uint64_t>(_periodMs > awakeMs ? _periodMs - awakeMs : 1000) * 1000ULL;
+    IOTLOGINFO2(F("Duty cycle sleep, awake [ms]: "), awakeMs,
+                String(F(", sleep [ms]: ")) + static_cast<uint32_t>(sleepUs / 1000));
+
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+#if defined(ESP8266)
+    if (sleepUs > ESP.deepSleepMax())
+    {
+        sleepUs = ESP.deepSleepMax();
+    }
+#endif
+    // The cached DHCP lease keeps ageing while asleep
+    IoTWiFiQuickConnect::ageCache(awakeMs + static_cast<uint32_t>(sleepUs / 1000));
+#if defined(ESP8266)
+    ESP.deepSleep(sleepUs);
+#elif defined(ESP32)
+    esp_deep_sleep(sleepUs);
+#endif
+}
+
+String IoTDutyCycle::statusJSON() const
+{
+    return JSONUtils::EncloseObject(
+        JSONUtils::Pair(F("cycles"), _record.cycles, true) +
+        JSONUtils::Pair(F("skipped"), _record.skipped) +
+        JSONUtils::Pair(F("lastAwakeMs"), _record.lastAwakeMs) +
+        JSONUtils::Pair(F("avgAwakeMs"), _record.avgAwakeMs));
+}
+
+#endif // WM_SUPPORT_HOME_ASSISTANT
@@ -0,0 +1,129 @@
+/*
+  IoTDutyCycle.h - Deep-sleep duty cycle for battery powered devices.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef IOTDUTYCYCLE_H
+#define IOTDUTYCYCLE_H
+
+#include <Arduino.h>
+#include "IoTRtcMemory.h"
+#include "IoTDevice.h"
+
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+
+/**
+ * @brief Wake - sample - publish changes - deep sleep.
+ *
+ * On every wake IoTApplication samples all components once and asks
+ * evaluate() which of them changed since their last successful publish
+ * (IoTHADeviceWrapperBase::changedSince(), i.e. outside the component's
+ * deadband). The last published values live in RTC memory, so when nothing
+ * changed the device goes back to sleep without turning WiFi on. Otherwise it
+ * connects (quick connect), publishes only the changed components and sleeps.
+ * Every heartbeatCycles wakes all components are published regardless, so
+ * Home Assistant keeps seeing the device.
+ *
+ * Sleep is scheduled so that wakes stay periodMs apart: the awake time of the
+ * cycle is subtracted from the period.
+ *
+ * ESP8266: GPIO16 must be wired to RST for the timer wake-up.
+ */
+class IoTDutyCycle
+{
+public:
+    /** Give up on WiFi/MQTT and sleep after this long awake. */
+    static constexpr uint32_t MAX_AWAKE_MS = 20000;
+
+    /** Keep MQTT running this long after publishing so the packets leave. */
+    static constexpr uint32_t FLUSH_MS = 250;
+
+    /**
+     * @brief Enable the duty cycle. Call before IoTApplication::setup().
+     */
+    void begin(uint32_t periodMs, uint16_t heartbeatCycles)
+    {
+        _periodMs        = periodMs;
+        _heartbeatCycles = heartbeatCycles;
+    }
+
+    bool enabled() const { return _periodMs != 0; }
+
+    /**
+     * @brief Load the record kept across deep sleep. Starts a fresh record
+     *        (everything counts as changed) after power-on or a firmware with
+     *        a different component count.
+     */
+    void restore(uint8_t componentCount);
+
+    /**
+     * @brief Compare freshly updated components with the retained values.
+     * @return true if the network is needed: something changed, heartbeat is
+     *         due or there is no valid retained state
+     */
+    bool evaluate(const IoTDevice& device);
+
+    /**
+     * @brief Publish the changed components (all of them on heartbeat) and
+     *        retain the values that were sent successfully.
+     */
+    void publish(IoTDevice& device);
+
+    /**
+     * @brief Save the record and deep sleep until the next period. Does not return.
+     * @param usedNetwork - false if this wake skipped WiFi
+     */
+    void sleep(bool usedNetwork);
+
+    /** @brief Awake time of the previous cycle [ms]. */
+    uint32_t lastAwakeMs() const { return _record.lastAwakeMs; }
+
+    /** @brief {"cycles":..,"skipped":..,"lastAwakeMs":..,"avgAwakeMs":..} */
+    String statusJSON() const;
+
+private:
+    static constexpr uint32_t MAGIC       = 0x44435931UL; // "DCY1"
+    static constexpr uint8_t  MAX_RETAINED = IOT_MAX_COMPONENTS;
+
+    struct Record
+    {
+        uint32_t magic;
+        uint32_t checksum;
+        uint32_t cycles;             ///< wakes since power-on
+        uint32_t skipped;            ///< wakes that did not use WiFi
+        uint32_t lastAwakeMs;
+        uint32_t avgAwakeMs;         ///< exponential average, 1/8 weight
+        uint16_t sincePublish;       ///< wakes since the last full publish
+        uint8_t  componentCount;
+        uint8_t  reserved;
+        uint32_t retained[MAX_RETAINED];
+    };
+
+    static_assert(sizeof(Record) <= IoTRtcMemory::DUTY_CYCLE_BLOCKS * 4,
+                  "IoTDutyCycle record does not fit its RTC blocks");
+
+    uint32_t _periodMs        = 0;
+    uint16_t _heartbeatCycles = 0;
+    bool     _valid           = false;
+    bool     _heartbeat       = false;
+    uint32_t _changedMask     = 0;
+    Record   _record          = {};
+};
+
+#endif // WM_SUPPORT_HOME_ASSISTANT
+
+#endif // IOTDUTYCYCLE_H
@@ -0,0 +1,167 @@
+/*
+  IoTFixedPoint.h - Decimal fixed-point number for FPU-less targets.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Signed decimal fixed-point value stored as int32_t scaled by 10^Precision.
+ *
+ * The ESP8266 has no FPU, so every float multiply, compare and format is a
+ * soft-float library call. IoTFixedPoint keeps sensor values as scaled integers
+ * end to end: IoTHASensorNumberWrapper<IoTFixedPoint<P>> hands the raw integer
+ * straight to ArduinoHA, and toChars() formats for JSON and the display using
+ * integer division only.
+ *
+ * Example — temperature in tenths of a degree:
+ * @code
+ *   using Temp = IoTFixedPoint<1>;
+ *   Temp t = Temp::fromScaled(rawMilliCelsius, 1000);   // 21537 m°C -> 21.5
+ *   char buf[Temp::MAX_CHARS];
+ *   t.toChars(buf, sizeof(buf));                        // "21.5"
+ * @endcode
+ *
+ * @tparam Precision  Number of decimal places (0–6).
+ */
+template<uint8_t Precision>
+class IoTFixedPoint
+{
+    static_assert(Precision <= 6, "IoTFixedPoint: Precision must be 0..6.");
+
+    static constexpr int32_t pow10(uint8_t n) { return n == 0 ? 1 : 10 * pow10(n - 1); }
+
+public:
+    /** Number of decimal places. */
+    static constexpr uint8_t PRECISION = Precision;
+
+    /** 10^Precision — raw units per 1.0. */
+    static constexpr int32_t SCALE = pow10(Precision);
+
+    /** Buffer size that fits any formatted value including sign, point and terminator. */
+    static constexpr size_t MAX_CHARS = 13;
+
+    constexpr IoTFixedPoint() = default;
+
+    /** @brief Create from a raw value already scaled by SCALE. */
+    static constexpr IoTFixedPoint fromRaw(int32_t raw) { return IoTFixedPoint(raw); }
+
+    /**
+     * @brief Create from an integer expressed in another scale, rounding half away
+     *        from zero. E.g. fromScaled(21537, 1000) with Precision 1 gives 21.5.
+     */
+    static constexpr IoTFixedPoint fromScaled(int32_t value, int32_t scale)
+    {
+        return IoTFixedPoint(static_cast<int32_t>(
+            (static_cast<int64_t>(value) * SCALE + (value < 0 ? -scale / 2 : scale / 2)) / scale));
+    }
+
+    /**
+     * @brief Create from a float. Intended for the edges of the system only
+     *        (e.g. a driver that can only return float).
+     */
+    static IoTFixedPoint fromFloat(float value)
+    {
+        const float scaled = value * static_cast<float>(SCALE);
+        return IoTFixedPoint(static_cast<int32_t>(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f));
+    }
+
+    /** @brief Raw value scaled by SCALE. */
+    constexpr int32_t raw() const { return _raw; }
+
+    /** @brief Convert to float (soft-float on ESP8266 — avoid on hot paths). */
+    float toFloat() const { return static_cast<float>(_raw) / static_cast<float>(SCALE); }
+
+    /**
+     * @brief Format as a decimal string ("-12.30" for Precision 2) without any
+     *        floating point arithmetic.
+     *
+     * @param buf  Destination buffer, MAX_CHARS bytes is always sufficient.
+     * @param len  Size of buf in bytes.
+     * @return Number of characters written (excluding the terminator), 0 if buf is too small.
+     */
+    size_t toChars(char* buf, size_t len) const
+    {
+        char tmp[MAX_CHARS];
+        size_t n = 0;
+        uint32_t mag = (_raw < 0) ? 0u - static_cast<uint32_t>(_raw) : static_cast<uint32_t>(_raw);
+
+        for (uint8_t i = 0; i < Precision; ++i)
+        {
+            tmp[n++] = static_cast<char>('0' + mag % 10);
+            mag /= 10;
+        }
+        if (Precision > 0)
+        {
+            tmp[n++] = '.';
+        }
+        do
+        {
+            tmp[n++] = static_cast<char>('0' + mag % 10);
+            mag /= 10;
+        } while (mag != 0);
+        if (_raw < 0)
+        {
+            tmp[n++] = '-';
+        }
+
+        if (n + 1 > len)
+        {
+            if (len > 0) buf[0] = '\0';
+            return 0;
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            buf[i] = tmp[n - 1 - i];
+        }
+        buf[n] = '\0';
+        return n;
+    }
+
+    constexpr bool operator==(const IoTFixedPoint& rhs) const { return _raw == rhs._raw; }
+    constexpr bool operator!=(const IoTFixedPoint& rhs) const { return _raw != rhs._raw; }
+    constexpr bool operator< (const IoTFixedPoint& rhs) const { return _raw <  rhs._raw; }
+    constexpr bool operator> (const IoTFixedPoint& rhs) const { return _raw >  rhs._raw; }
+    constexpr bool operator<=(const IoTFixedPoint& rhs) const { return _raw <= rhs._raw; }
+    constexpr bool operator>=(const IoTFixedPoint& rhs) const { return _raw >= rhs._raw; }
+
+    constexpr IoTFixedPoint operator+(const IoTFixedPoint& rhs) const { return IoTFixedPoint(_raw + rhs._raw); }
+    constexpr IoTFixedPoint operator-(const IoTFixedPoint& rhs) const { return IoTFixedPoint(_raw - rhs._raw); }
+
+private:
+    constexpr explicit IoTFixedPoint(int32_t raw) : _raw(raw) {}
+
+    int32_t _raw = 0;
+};
+
+/**
+ * @brief Trait to detect IoTFixedPoint<P> in templates.
+ */
+template<typename T>
+struct IoTIsFixedPoint
+{
+    static constexpr bool value = false;
+};
+
+template<uint8_t P>
+struct IoTIsFixedPoint<IoTFixedPoint<P>>
+{
+    static constexpr bool value = true;
+};
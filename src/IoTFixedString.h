@@ -0,0 +1,85 @@
+/*
+  IoTFixedString.h - Fixed-capacity inline string for settings fields.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef IOTFIXEDSTRING_H
+#define IOTFIXEDSTRING_H
+
+#include <stddef.h>
+#include <string.h>
+
+/**
+ * @brief NUL-terminated string of at most N characters stored inline.
+ *
+ * No heap is used: sizeof(IoTFixedString<N>) is N + 1 and copies are plain
+ * memory copies. Longer input is truncated to N characters, assign() reports
+ * it. Used for Settings fields so that reading and saving them does not
+ * allocate.
+ *
+ * @tparam N - capacity in characters, excluding the terminating NUL
+ */
+template<size_t N>
+class IoTFixedString
+{
+public:
+    static_assert(N > 0, "IoTFixedString: capacity must be positive.");
+
+    static constexpr size_t CAPACITY = N;
+
+    IoTFixedString() = default;
+    IoTFixedString(const char* s) { assign(s); }
+
+    const char* c_str() const { return _buf; }
+    size_t length() const { return strlen(_buf); }
+    bool isEmpty() const { return _buf[0] == '\0'; }
+
+    /**
+     * @brief Copy len characters of s (s need not be NUL-terminated there).
+     * @return false if the value was truncated to CAPACITY
+     */
+    bool assign(const char* s, size_t len)
+    {
+        const bool fits = len <= N;
+        if (!fits)
+        {
+            len = N;
+        }
+        memmove(_buf, s, len);
+        _buf[len] = '\0';
+        return fits;
+    }
+
+    bool assign(const char* s) { return assign(s ? s : "", s ? strlen(s) : 0); }
+
+    /** @brief Compare with the first len characters of s. */
+    bool equals(const char* s, size_t len) const
+    {
+        return len <= N && strncmp(_buf, s, len) == 0 && _buf[len] == '\0';
+    }
+
+    bool operator==(const char* s) const { return strcmp(_buf, s ? s : "") == 0; }
+    bool operator!=(const char* s) const { return !(*this == s); }
+
+    /** @brief Writable buffer of CAPACITY + 1 bytes, e.g. for Preferences::getString(). */
+    char* buffer() { return _buf; }
+
+private:
+    char _buf[N + 1] = {};
+};
+
+#endif // IOTFIXEDSTRING_H
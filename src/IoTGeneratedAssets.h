@@ -0,0 +1,89 @@
+// Generated by tools/gzip_assets.py - do not edit.
+#pragma once
+
+#include "IoTStaticAsset.h"
+
+// hw-status.js: 2966 -> 1231 bytes (59%)
+const uint8_t IOT_ASSET_HW_STATUS_JS_DATA[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8d, 0x56, 0xdf, 0x6f, 0xdb, 0x36,
+    0x10, 0x7e, 0xf7, 0x5f, 0x71, 0x7b, 0x89, 0xe4, 0xc6, 0x91, 0xd3, 0x60, 0x7b, 0x89, 0x61, 0x04,
+    0x69, 0x16, 0x64, 0x59, 0x9d, 0x3a, 0x88, 0xd7, 0xa7, 0xa1, 0x28, 0x68, 0xe9, 0x6c, 0x33, 0x95,
+    0x49, 0x8d, 0xa4, 0xec, 0x7a, 0xad, 0xff, 0xf7, 0xdd, 0x91, 0xfa, 0xe5, 0xa4, 0xcd, 0x82, 0x00,
+    0x89, 0x22, 0x1e, 0x3f, 0xdd, 0xf7, 0xdd, 0x77, 0x47, 0x0e, 0xdf, 0xf4, 0x00, 0x56, 0xdb, 0x13,
+    0xeb, 0x84, 0x2b, 0x6d, 0xf2, 0x68, 0xe1, 0x04, 0xae, 0xf4, 0xba, 0xd0, 0x0a, 0x95, 0x83, 0xf0,
+    0x16, 0x9c, 0x98, 0xe7, 0x08, 0x0b, 0x6d, 0xc0, 0xad, 0x10, 0x6e, 0xf5, 0x5f, 0x97, 0x45, 0x91,
+    0xcb, 0x54, 0x38, 0xa9, 0x15, 0x6c, 0x71, 0x0e, 0x1f, 0x6f, 0x13, 0x82, 0xb9, 0xd2, 0xc5, 0xce,
+    0xc8, 0xe5, 0xca, 0x41, 0x9c, 0xf6, 0xe1, 0xec, 0xf4, 0xec, 0x57, 0xb8, 0x47, 0x87, 0x06, 0xde,
+    0x8b, 0x1c, 0x1f, 0x45, 0x02, 0x70, 0x99, 0xe7, 0x10, 0x22, 0x0c, 0x5a, 0x34, 0x1b, 0xcc, 0xe8,
+    0xe5, 0x44, 0xa6, 0xa8, 0x2c, 0x9e, 0xc3, 0xe4, 0xe6, 0x7e, 0x72, 0x72, 0x96, 0xbc, 0x3d, 0xee,
+    0x11, 0xd8, 0xcc, 0x2f, 0xc3, 0xf2, 0x5f, 0x59, 0x14, 0xf4, 0x77, 0x61, 0xf4, 0x1a, 0xee, 0x1f,
+    0xa6, 0x37, 0x77, 0xd7, 0x77, 0x20, 0x2c, 0x0c, 0xbb, 0x39, 0x27, 0x70, 0xb9, 0xe0, 0xef, 0x60,
+    0x26, 0x9d, 0x54, 0xcb, 0x01, 0xa1, 0x2f, 0x51, 0xa1, 0x11, 0x0e, 0x09, 0xc9, 0x9a, 0x74, 0x48,
+    0x39, 0xdf, 0x54, 0x6f, 0xb2, 0x4b, 0x6b, 0xd1, 0xd9, 0x64, 0x75, 0x4e, 0x6b, 0x00, 0x4e, 0xeb,
+    0xdc, 0x0e, 0xf9, 0x33, 0x9f, 0x45, 0x58, 0x28, 0x76, 0x70, 0xa2, 0x7f, 0xba, 0x0b, 0x32, 0xe1,
+    0xc4, 0xc1, 0xd7, 0x7b, 0x6f, 0x86, 0xbd, 0x78, 0x51, 0xaa, 0xd4, 0xcb, 0x11, 0xf7, 0xe1, 0x1b,
+    0x01, 0x47, 0xa5, 0x45, 0x92, 0xcf, 0xc8, 0xd4, 0x45, 0x23, 0xe6, 0xb3, 0x11, 0x06, 0xee, 0xa7,
+    0x93, 0xc9, 0xe7, 0xbb, 0x19, 0x8c, 0xe1, 0xb7, 0xd3, 0xd3, 0xd3, 0x51, 0xf5, 0xd6, 0xa6, 0x46,
+    0x16, 0x8e, 0x5e, 0x66, 0x3a, 0x2d, 0xd7, 0x24, 0x7b, 0x92, 0x96, 0xc6, 0xd0, 0xdf, 0x99, 0x5f,
+    0xa8, 0xc3, 0x42, 0x11, 0x3a, 0x51, 0x4b, 0x74, 0xd7, 0x39, 0xf2, 0xe3, 0xbb, 0xdd, 0x6d, 0x16,
+    0x47, 0xab, 0x6d, 0x48, 0x29, 0xea, 0xf3, 0x16, 0xb9, 0x80, 0xf8, 0x17, 0xbf, 0x27, 0x24, 0x04,
+    0xcf, 0x01, 0x52, 0x83, 0xc4, 0xac, 0xc2, 0x88, 0x23, 0xbf, 0x1e, 0x36, 0x57, 0xc1, 0x89, 0xcc,
+    0x28, 0xbe, 0x05, 0x0e, 0x4b, 0x21, 0xdf, 0xa4, 0x10, 0x9c, 0xe3, 0x07, 0x9d, 0x51, 0x18, 0x95,
+    0xcf, 0xb8, 0x77, 0x48, 0x0e, 0xc1, 0xd8, 0xef, 0x1c, 0xd4, 0x51, 0x0a, 0xbf, 0xba, 0x99, 0x9c,
+    0xe7, 0x54, 0x16, 0x8f, 0xbc, 0x67, 0x2d, 0x86, 0x43, 0x98, 0x2a, 0x04, 0xa3, 0xb7, 0x50, 0x50,
+    0xd9, 0xd2, 0xc6, 0x6f, 0x7a, 0xfe, 0x88, 0xa9, 0x3b, 0x07, 0x25, 0xd6, 0x04, 0xb1, 0x11, 0x79,
+    0x89, 0xb0, 0x95, 0x6e, 0x05, 0xa5, 0x92, 0x8e, 0x30, 0xe9, 0x39, 0x5d, 0x51, 0xc9, 0x96, 0xcb,
+    0x9c, 0x2b, 0xdb, 0x88, 0x4e, 0x48, 0x6c, 0xb9, 0xc0, 0xd3, 0x8b, 0x65, 0x5e, 0x22, 0x6a, 0x6a,
+    0x96, 0x1c, 0xca, 0xdf, 0x7a, 0x29, 0x38, 0xeb, 0x06, 0x87, 0x94, 0x5e, 0x13, 0xcd, 0xb0, 0x89,
+    0x23, 0xf6, 0x57, 0x5a, 0x39, 0xe6, 0x36, 0x86, 0x34, 0xf1, 0xdf, 0xfa, 0xfe, 0x1d, 0xa2, 0xa8,
+    0x86, 0x24, 0xb8, 0x67, 0x51, 0xe1, 0x23, 0xc7, 0xd4, 0x45, 0x09, 0xf3, 0x86, 0x0b, 0x88, 0xe8,
+    0xe7, 0x18, 0xaa, 0x7f, 0xcf, 0x69, 0x7b, 0x5d, 0x25, 0x93, 0x08, 0x6a, 0x0f, 0x95, 0x5d, 0xad,
+    0x64, 0x9e, 0xc5, 0x0c, 0xff, 0xe3, 0x15, 0x0f, 0x59, 0x2d, 0xb1, 0x33, 0xd2, 0xc4, 0xed, 0x0a,
+    0x22, 0x32, 0xa6, 0xf2, 0x06, 0x55, 0x23, 0x38, 0x3a, 0xe2, 0x2f, 0xc8, 0xac, 0xd6, 0xb1, 0x52,
+    0x32, 0x7b, 0x15, 0xdd, 0x10, 0x3c, 0x77, 0xea, 0x85, 0xe8, 0x79, 0xe9, 0x9c, 0x56, 0xed, 0x0e,
+    0x8a, 0x7e, 0xc6, 0x9d, 0x9d, 0x86, 0xcc, 0x78, 0xba, 0x58, 0x44, 0x4c, 0x75, 0xaa, 0xa2, 0x6e,
+    0xbc, 0x56, 0x29, 0x4d, 0x9e, 0x2f, 0x14, 0xfb, 0xb4, 0xe3, 0xda, 0x98, 0x4c, 0x5a, 0xf6, 0x20,
+    0x27, 0xee, 0x4c, 0x89, 0xa3, 0x66, 0x71, 0x81, 0x44, 0x34, 0x8e, 0x86, 0xa2, 0x90, 0xc3, 0xc0,
+    0xfa, 0x42, 0x66, 0x63, 0x96, 0x16, 0x55, 0x4a, 0x46, 0xfe, 0xf8, 0x70, 0xdb, 0xcc, 0xbe, 0xb8,
+    0xd2, 0xe2, 0x18, 0xa2, 0x23, 0x9f, 0x94, 0x8f, 0x8b, 0xdb, 0x0c, 0x4f, 0x29, 0xbb, 0xb7, 0xfd,
+    0x7e, 0x03, 0x0e, 0x90, 0xd0, 0x74, 0x54, 0xb1, 0xc1, 0x05, 0x0d, 0xb7, 0x15, 0x0f, 0x21, 0xff,
+    0xd0, 0xd0, 0xdd, 0xd7, 0x0f, 0x2e, 0x3b, 0xa8, 0x0d, 0xa5, 0xdc, 0xc4, 0x3c, 0x29, 0x9b, 0xcb,
+    0xaa, 0x95, 0xbd, 0xff, 0x6d, 0xd0, 0x95, 0x46, 0x51, 0x50, 0xd3, 0x49, 0x2c, 0x3a, 0x99, 0xdf,
+    0x12, 0xd5, 0x6f, 0x7b, 0x3f, 0x67, 0x1a, 0x59, 0xbe, 0xe0, 0x2e, 0x4e, 0x07, 0x20, 0x49, 0x9d,
+    0x7a, 0xa3, 0xa7, 0xc4, 0xfe, 0x6b, 0x9d, 0x38, 0xa3, 0x11, 0xa5, 0x96, 0xb1, 0xec, 0x8f, 0x02,
+    0x60, 0xdb, 0x52, 0x94, 0x04, 0x9a, 0x38, 0x97, 0xd6, 0x1d, 0x0c, 0x90, 0x27, 0x15, 0xab, 0x9d,
+    0xdc, 0x49, 0x82, 0xff, 0xe5, 0x6d, 0x09, 0x8d, 0x83, 0x6b, 0x41, 0x82, 0xb7, 0x95, 0xaa, 0xf2,
+    0xe9, 0xda, 0x8b, 0x1b, 0x35, 0xb4, 0x6f, 0xad, 0x01, 0x43, 0xfd, 0xdd, 0x64, 0xff, 0xc9, 0x57,
+    0xb1, 0xd1, 0xc7, 0xa7, 0x70, 0x20, 0x91, 0xa9, 0x25, 0x3a, 0x98, 0x2f, 0x0f, 0x58, 0xe4, 0x22,
+    0x45, 0x7f, 0x60, 0xf9, 0xdc, 0xf4, 0xc2, 0x3f, 0x37, 0xb3, 0xc6, 0x82, 0x54, 0x20, 0x20, 0xc3,
+    0xdc, 0x09, 0xc0, 0x0d, 0xbd, 0x19, 0x40, 0xc0, 0x05, 0x85, 0x5b, 0xa0, 0x18, 0xdb, 0x95, 0xa3,
+    0x10, 0x6c, 0x9d, 0xae, 0x1a, 0xaf, 0xa6, 0xc8, 0x66, 0x6d, 0xe8, 0x8c, 0x5e, 0xe6, 0xce, 0xbd,
+    0x19, 0xf8, 0x7f, 0xea, 0xba, 0x3a, 0xd0, 0x36, 0x81, 0x53, 0xcd, 0x7b, 0x00, 0x75, 0x64, 0xe3,
+    0x30, 0xc0, 0x9c, 0x8e, 0x9d, 0xa7, 0xfb, 0x7e, 0x28, 0x57, 0xed, 0xa9, 0x5a, 0xef, 0xae, 0xce,
+    0x1d, 0x29, 0x7d, 0x9e, 0x72, 0x8d, 0x9c, 0xaa, 0x2a, 0xf3, 0x7c, 0xf4, 0xc4, 0x24, 0xde, 0xe2,
+    0x4d, 0x07, 0x92, 0xf0, 0xb3, 0x9d, 0x75, 0xb8, 0x86, 0x7f, 0x4a, 0x34, 0x12, 0x2d, 0xd0, 0x21,
+    0x01, 0x42, 0xd9, 0x2d, 0x1a, 0xea, 0xc7, 0xf9, 0xce, 0xd7, 0xa0, 0x10, 0x4b, 0x2e, 0x8c, 0x70,
+    0x90, 0x6b, 0x91, 0xd1, 0xf5, 0x62, 0x25, 0x6d, 0x75, 0x5e, 0x74, 0x6d, 0x1e, 0xba, 0x35, 0xd7,
+    0xe1, 0x9e, 0x41, 0xe7, 0x8d, 0x5b, 0x79, 0xd7, 0x52, 0x47, 0x5e, 0x64, 0x5f, 0xc7, 0xed, 0x71,
+    0xd7, 0xeb, 0xb6, 0x5f, 0x5b, 0x09, 0xd3, 0x71, 0xbe, 0xa1, 0x73, 0x5a, 0xab, 0x98, 0x5d, 0x7e,
+    0x18, 0x1e, 0x6c, 0x3e, 0x38, 0x9c, 0x26, 0x1d, 0xfe, 0xad, 0x01, 0x74, 0x9e, 0x37, 0x3c, 0xb9,
+    0x4c, 0x95, 0x2a, 0xe3, 0xa0, 0x4b, 0x5b, 0xad, 0x46, 0x93, 0xc6, 0xb3, 0x95, 0x7c, 0x74, 0x7f,
+    0xb8, 0xa5, 0xb6, 0x31, 0x34, 0x8b, 0xdb, 0x21, 0x51, 0x5d, 0x09, 0x3a, 0x6d, 0x5e, 0x3b, 0xf8,
+    0xbe, 0xb4, 0x74, 0xee, 0x15, 0x74, 0xdd, 0x20, 0x19, 0xf5, 0x86, 0x20, 0xfc, 0xdc, 0xf2, 0x56,
+    0xb5, 0x23, 0x9f, 0x0f, 0x6c, 0x89, 0x82, 0x97, 0x94, 0x6e, 0x1a, 0x28, 0xd6, 0x40, 0x3a, 0x96,
+    0x4a, 0x6c, 0x84, 0xcc, 0xb9, 0xf0, 0x01, 0x27, 0xd6, 0x39, 0x29, 0xcf, 0x45, 0x66, 0x9e, 0x7f,
+    0x5c, 0x82, 0x2d, 0x8b, 0x42, 0x1b, 0x07, 0xcd, 0x98, 0xa4, 0x7b, 0x9d, 0x20, 0xb0, 0x0a, 0xc3,
+    0xe6, 0x9a, 0x9a, 0x63, 0x5e, 0xda, 0x5d, 0xbf, 0xba, 0x46, 0x6c, 0xa5, 0xca, 0xf4, 0x36, 0xb9,
+    0xe6, 0x2f, 0xcf, 0x74, 0x69, 0x52, 0xec, 0x1e, 0xb5, 0xc8, 0x7d, 0xcf, 0x2d, 0xd3, 0x59, 0xaf,
+    0x66, 0x6c, 0xc8, 0xb5, 0x1e, 0xf8, 0x68, 0x13, 0x91, 0x65, 0x3e, 0x6a, 0x42, 0xbd, 0xc3, 0x17,
+    0xab, 0x38, 0x5a, 0x90, 0x76, 0x51, 0x57, 0x7e, 0x0c, 0x55, 0xf3, 0xc3, 0xe7, 0xcf, 0xd9, 0xf4,
+    0x03, 0xdf, 0x33, 0x2c, 0xc6, 0x98, 0xf0, 0xbd, 0xab, 0xef, 0x0b, 0xf8, 0x02, 0x9c, 0x6f, 0xe7,
+    0xe7, 0x78, 0xa1, 0x7b, 0xff, 0x0f, 0x8e, 0x7a, 0xde, 0x18, 0x6d, 0x7e, 0x72, 0xb6, 0xb0, 0x12,
+    0x14, 0x44, 0x1a, 0x65, 0xbb, 0x99, 0x3f, 0x03, 0xb8, 0xf6, 0x1d, 0xd2, 0xc9, 0xd5, 0x64, 0x3a,
+    0xbb, 0xfe, 0xbd, 0xdb, 0xb7, 0xc1, 0x34, 0x87, 0x0d, 0xe7, 0x27, 0xe4, 0x41, 0xa7, 0xb6, 0x51,
+    0xfb, 0xde, 0xbe, 0xcf, 0x4f, 0xff, 0x01, 0x5d, 0x35, 0x78, 0x94, 0x96, 0x0b, 0x00, 0x00,
+};
+const char IOT_ASSET_HW_STATUS_JS_TYPE[] PROGMEM = "application/javascript";
+const char IOT_ASSET_HW_STATUS_JS_ETAG[] PROGMEM = "\"ba9bd3e6\"";
+const IoTStaticAsset IOT_ASSET_HW_STATUS_JS = { IOT_ASSET_HW_STATUS_JS_TYPE, IOT_ASSET_HW_STATUS_JS_DATA, sizeof(IOT_ASSET_HW_STATUS_JS_DATA), true, IOT_ASSET_HW_STATUS_JS_ETAG };
+#define IOT_ASSET_HW_STATUS_JS_GZ 1
@@ -0,0 +1,292 @@
+/*
+  IoTHABinarySensorWrapper.h - HA wrapper for an interrupt-driven GPIO input.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef IOTHABINARYSENSORWRAPPER_H
+#define IOTHABINARYSENSORWRAPPER_H
+
+#include <Arduino.h>
+#include <ArduinoHA.h>
+#include <atomic>
+#include "IoTHADeviceWrapperBase.h"
+#include "IoTIdleScheduler.h"
+#include "DeviceDefines.h"   // LanguageSupport.h → L_GENERAL_ON/OFF
+#include "JSONUtils.h"
+
+#ifndef IOT_BINARY_SENSOR_EDGE_QUEUE
+    #define IOT_BINARY_SENSOR_EDGE_QUEUE 16
+#endif
+
+/**
+ * @class IoTHABinarySensorWrapper
+ * @brief HA binary sensor for a button or contact on a GPIO input.
+ *
+ * A CHANGE interrupt timestamps every edge (micros()) into a fixed ring, so
+ * no pulse is lost while loop() is busy. poll(), called on every loop() pass,
+ * drains the ring and debounces by time: a level is accepted once it was
+ * stable for the debounce time, measured between the edge timestamps. A pulse
+ * longer than the debounce time is therefore published (ON and OFF) even if
+ * loop() only got to it later. Accepted changes are published right away.
+ *
+ * The ISR only writes the ring and wakes IoTIdleScheduler. Publish latency,
+ * from the edge that started the stable level to the MQTT publish, is kept in
+ * lastLatencyUs()/maxLatencyUs(). It includes the debounce time.
+ *
+ * Example:
+ * @code
+ *   IoTHABinarySensorWrapper m_door(D5, "door", false, true);   // contact to GND
+ *
+ *   // In constructor:
+ *   registerComponent(m_door);
+ *
+ *   // In postSetup():
+ *   m_door.setName("Door");
+ *   m_door.setDeviceClass("door");
+ * @endcode
+ */
+class IoTHABinarySensorWrapper : public IoTHADeviceWrapperBase
+{
+public:
+    static constexpr uint8_t QUEUE_SIZE = IOT_BINARY_SENSOR_EDGE_QUEUE;
+    static_assert((QUEUE_SIZE & (QUEUE_SIZE - 1)) == 0 && QUEUE_SIZE <= 128,
+                  "IOT_BINARY_SENSOR_EDGE_QUEUE must be a power of two, at most 128");
+
+    /**
+     * @brief Construct the binary sensor wrapper.
+     *
+     * @param pin        GPIO input pin with interrupt support.
+     * @param uid        Unique HA entity ID string.
+     * @param activeHigh If true (default), pin HIGH = ON.
+     * @param pullup     Enable the internal pull-up (contact to GND).
+     * @param debounceMs Time a level must be stable to be accepted.
+     */
+    IoTHABinarySensorWrapper(uint8_t pin, const char* uid, bool activeHigh = true,
+                             bool pullup = false, uint16_t debounceMs = 30)
+        : _sensor(uid)
+        , _pin(pin)
+        , _activeHigh(activeHigh)
+        , _pullup(pullup)
+        , _debounceUs(static_cast<uint32_t>(debounceMs) * 1000)
+    {}
+
+    IoTHABinarySensorWrapper(const IoTHABinarySensorWrapper&)            = delete;
+    IoTHABinarySensorWrapper& operator=(const IoTHABinarySensorWrapper&) = delete;
+
+    ~IoTHABinarySensorWrapper() override { detachInterrupt(digitalPinToInterrupt(_pin)); }
+
+    // -----------------------------------------------------------------------
+    // HA entity configuration — delegate to HABinarySensor
+    // -----------------------------------------------------------------------
+
+    /** @brief Set the display name of the sensor in Home Assistant. */
+    void setName(const char* name)
+    {
+        _name = name;
+        _sensor.setName(name);
+    }
+
+    /** @brief Return the name set via setName(), or nullptr if unset. */
+    const char* name() const { return _name; }
+
+    /** @brief Set the MaterialDesignIcons icon (e.g. "mdi:door"). */
+    void setIcon(const char* icon) { _sensor.setIcon(icon); }
+
+    /**
+     * @brief Set the HA device class.
+     * See https://www.home-assistant.io/integrations/binary_sensor/#device-class
+     */
+    void setDeviceClass(const char* deviceClass) { _sensor.setDeviceClass(deviceClass); }
+
+    /** @brief Debounced state (true = ON). */
+    bool getCurrentState() const { return _stable; }
+
+    /** @brief Edges seen by the ISR. */
+    uint32_t edgeCount() const { return _edges.load(std::memory_order_relaxed); }
+
+    /** @brief Edges dropped because the ring was full. */
+    uint32_t overflowCount() const { return _overflows.load(std::memory_order_relaxed); }
+
+    /** @brief Edge-to-publish time of the last accepted change [us], debounce included. */
+    uint32_t lastLatencyUs() const { return _lastLatencyUs; }
+
+    /** @brief Largest edge-to-publish time since boot [us], debounce included. */
+    uint32_t maxLatencyUs() const { return _maxLatencyUs; }
+
+    // -----------------------------------------------------------------------
+    // IoTHADeviceWrapperBase
+    // -----------------------------------------------------------------------
+
+    /**
+     * @brief Drain the edge ring, debounce and publish accepted changes.
+     */
+    bool poll() override
+    {
+        bool changed = false;
+        const uint8_t head = _head.load(std::memory_order_acquire);
+        while (_tail != head)
+        {
+            const Edge& e = _ring[_tail];
+            changed |= settle(e.us);
+            _raw      = e.level;
+            _rawSince = e.us;
+            _tail = static_cast<uint8_t>((_tail + 1) & (QUEUE_SIZE - 1));
+        }
+        _tailShared.store(_tail, std::memory_order_release);
+
+        // Edges were dropped: the last queued level may be stale
+        const uint32_t overflows = overflowCount();
+        if (overflows != _seenOverflows)
+        {
+            _seenOverflows = overflows;
+            const bool level = levelToState(digitalRead(_pin));
+            if (level != _raw)
+            {
+                _raw      = level;
+                _rawSince = micros();
+            }
+        }
+        changed |= settle(micros());
+        return changed;
+    }
+
+    uint32_t msUntilNextPoll() const override
+    {
+        if (_head.load(std::memory_order_acquire) != _tail)
+        {
+            return 0;
+        }
+        if (_raw == _stable)
+        {
+            return UINT32_MAX;
+        }
+        const uint32_t stableUs = micros() - _rawSince;
+        return stableUs >= _debounceUs ? 0 : (_debounceUs - stableUs + 999) / 1000;
+    }
+
+    /**
+     * @brief Publish the debounced state.
+     * @param force  Pass true to publish even if the state has not changed.
+     */
+    bool publishValue(const bool force = false) override
+    {
+        return _sensor.setState(_stable, force);
+    }
+
+    /**
+     * @brief Return a JSON object for the web status table.
+     *        Produces: {"name":"...","value":"On"} or {"value":"Off"}
+     */
+    String statusJSON() const override
+    {
+        const bool hasName = _name && _name[0] != '\0';
+        String obj;
+        if (hasName)
+        {
+            obj += JSONUtils::Pair(F("name"), _name, true);
+        }
+        obj += JSONUtils::Pair(F("value"), _stable ? L_GENERAL_ON : L_GENERAL_OFF, !hasName);
+        return JSONUtils::EncloseObject(obj);
+    }
+
+protected:
+    /**
+     * @brief Configure the pin, take the initial level and attach the ISR.
+     *        Called automatically by IoTDevice::preSetup().
+     */
+    void begin() override
+    {
+        pinMode(_pin, _pullup ? INPUT_PULLUP : INPUT);
+        _raw      = levelToState(digitalRead(_pin));
+        _rawSince = micros();
+        _stable   = _raw;
+        _sensor.setCurrentState(_stable);
+        attachInterruptArg(digitalPinToInterrupt(_pin), onEdge, this, CHANGE);
+    }
+
+private:
+    struct Edge
+    {
+        uint32_t us;
+        bool     level;   ///< logical state after the edge
+    };
+
+    bool levelToState(int level) const { return (level == HIGH) == _activeHigh; }
+
+    // Accept _raw if it has been stable for the debounce time at nowUs
+    bool settle(uint32_t nowUs)
+    {
+        if (_raw == _stable || nowUs - _rawSince < _debounceUs)
+        {
+            return false;
+        }
+        _stable = _raw;
+        _sensor.setState(_stable);
+        _lastLatencyUs = micros() - _rawSince;
+        if (_lastLatencyUs > _maxLatencyUs)
+        {
+            _maxLatencyUs = _lastLatencyUs;
+        }
+        return true;
+    }
+
+    static void IRAM_ATTR onEdge(void* arg)
+    {
+        IoTHABinarySensorWrapper* self = static_cast<IoTHABinarySensorWrapper*>(arg);
+        const uint8_t head = self->_head.load(std::memory_order_relaxed);
+        const uint8_t next = static_cast<uint8_t>((head + 1) & (QUEUE_SIZE - 1));
+
+        self->_edges.store(self->_edges.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        if (next == self->_tailShared.load(std::memory_order_acquire))
+        {
+            self->_overflows.store(self->_overflows.load(std::memory_order_relaxed) + 1,
+                                   std::memory_order_relaxed);
+        }
+        else
+        {
+            self->_ring[head].us    = micros();
+            self->_ring[head].level = (digitalRead(self->_pin) == HIGH) == self->_activeHigh;
+            self->_head.store(next, std::memory_order_release);
+        }
+        IoTIdleScheduler::wake();
+    }
+
+    HABinarySensor _sensor;
+    uint8_t        _pin;
+    bool           _activeHigh;
+    bool           _pullup;
+    uint32_t       _debounceUs;
+    const char*    _name = nullptr;
+
+    // Edge ring: written by the ISR (head), drained by poll() (tail)
+    Edge                  _ring[QUEUE_SIZE] = {};
+    std::atomic<uint8_t>  _head{0};
+    std::atomic<uint8_t>  _tailShared{0};
+    uint8_t               _tail = 0;
+    std::atomic<uint32_t> _edges{0};
+    std::atomic<uint32_t> _overflows{0};
+
+    // Debounce state, loop() context
+    bool     _raw       = false;
+    uint32_t _rawSince  = 0;
+    bool     _stable    = false;
+    uint32_t _lastLatencyUs = 0;
+    uint32_t _maxLatencyUs  = 0;
+    uint32_t _seenOverflows = 0;
+};
+
+#endif // IOTHABINARYSENSORWRAPPER_H
@@ -22,6 +22,12 @@
 #define IOTHADEVICEWRAPPERBASE_H
 
 #include <ArduinoHA.h>
+#include "IoTSystemEventBus.h"
+#include "IoTRtcMemory.h"
+
+#ifndef IOT_MAX_HA_DEVICE_TYPES
+    #define IOT_MAX_HA_DEVICE_TYPES 24   // HA entities HAMqtt can hold (ArduinoHA default: 6)
+#endif
 
 // Forward declaration — allows IoTDevice to be a friend without a full include.
 class IoTDevice;
@@ -35,8 +41,11 @@ class IoTDevice;
  *
  * All derived classes must implement the publishValue() method, which is intended to send the current
  * value or state of the device to Home Assistant, optionally forcing the update even if the value has not changed.
+ *
+ * Components that react to system events override onSystemEvent() and systemEventMask();
+ * IoTDevice::registerComponent() subscribes them.
  */
-class IoTHADeviceWrapperBase
+class IoTHADeviceWrapperBase : public IoTSystemEventListener
 {
     friend class IoTDevice;
 
@@ -77,6 +86,45 @@ public:
      */
     virtual bool update(bool force = false) { return true; }
 
+    /**
+     * @brief Split-phase update, first half: start a measurement (e.g. a
+     *        DS18B20 conversion) without waiting for its result.
+     *
+     * IoTDevice starts every component before collecting any, so slow
+     * conversions overlap and an update cycle costs only the longest one.
+     * The default starts nothing and returns 0, so collect() (and with it
+     * update()) runs in the same pass.
+     *
+     * @param force Same as for update().
+     * @return Milliseconds until the result can be collected.
+     */
+    virtual uint32_t startMeasurement(bool force) { return 0; }
+
+    /**
+     * @brief Split-phase update, second half: read the result of
+     *        startMeasurement(). Called once its delay has passed.
+     *        Default calls update(force).
+     *
+     * @return true on success, false on hardware error.
+     */
+    virtual bool collect(bool force) { return update(force); }
+
+    /**
+     * @brief Called on every loop() pass, for components that must react
+     *        faster than the update cycle (e.g. interrupt-driven inputs).
+     *        Keep it short. Default: no-op.
+     *
+     * @return true if statusJSON() changed, so the status snapshot is
+     *         refreshed in the same pass.
+     */
+    virtual bool poll() { return false; }
+
+    /**
+     * @brief Milliseconds until poll() has work, used by the idle policy.
+     *        Default: UINT32_MAX (never).
+     */
+    virtual uint32_t msUntilNextPoll() const { return UINT32_MAX; }
+
     /**
      * @brief Return a JSON fragment describing current sensor state for the web UI.
      *
@@ -97,6 +145,23 @@ public:
      */
     virtual bool handleWebCommand(const char* uid, bool state) { return false; }
 
+    /**
+     * @brief Compact form of the current value, kept in RTC memory across deep
+     *        sleep by IoTDutyCycle. Default: hash of statusJSON().
+     */
+    virtual uint32_t retainedValue() const
+    {
+        const String status = statusJSON();
+        return IoTRtcMemory::checksum(status.c_str(), status.length());
+    }
+
+    /**
+     * @brief True if the current value differs from retained (an earlier
+     *        retainedValue()) enough to be published again. Default: any change.
+     *        Numeric sensors override this to apply their deadband.
+     */
+    virtual bool changedSince(uint32_t retained) const { return retainedValue() != retained; }
+
 protected:
     /**
      * @brief Initialise the device/sensor on application start-up.
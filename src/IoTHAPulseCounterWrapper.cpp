@@ -0,0 +1,296 @@
+/*
+  IoTHAPulseCounterWrapper.cpp - HA wrapper for an S0 pulse counter (energy, water).
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+
+#include "IoTHAPulseCounterWrapper.h"
+#include "IoTFixedPoint.h"
+#include "IoTDebug.h"
+#include "JSONUtils.h"
+
+IoTPulseCounterSettings::IoTPulseCounterSettings(const char* uid)
+    : Settings("PULSE")
+{
+    snprintf(_key, sizeof(_key), "T%08lx",
+             static_cast<unsigned long>(IoTRtcMemory::checksum(uid, strlen(uid))));
+}
+
+void IoTPulseCounterSettings::readFields(Preferences& pref)
+{
+    _total = pref.getULong64(_key, 0);
+}
+
+bool IoTPulseCounterSettings::saveFields(Preferences& pref) const
+{
+    return pref.putULong64(_key, _total) == sizeof(_total);
+}
+
+IoTHAPulseCounterWrapper::IoTHAPulseCounterWrapper(uint8_t pin, const char* totalUid, const char* rateUid,
+                                                   uint32_t pulsesPerUnit, uint32_t minPulseIntervalUs,
+                                                   bool risingEdge)
+    : _totalSensor(totalUid, HABaseDeviceType::PrecisionP3)
+    , _rateSensor(rateUid, HABaseDeviceType::PrecisionP3)
+    , _pin(pin)
+    , _risingEdge(risingEdge)
+    , _rtcSlot(s_counterCount < MAX_COUNTERS ? s_counterCount++ : MAX_COUNTERS)
+    , _pulsesPerUnit(pulsesPerUnit ? pulsesPerUnit : 1)
+    , _minIntervalUs(minPulseIntervalUs)
+    , _settings(totalUid)
+{
+    _totalSensor.setStateClass("total_increasing");
+    _rateSensor.setStateClass("measurement");
+}
+
+void IoTHAPulseCounterWrapper::setNames(const char* totalName, const char* rateName)
+{
+    _totalName = totalName;
+    _rateName  = rateName;
+    _totalSensor.setName(totalName);
+    _rateSensor.setName(rateName);
+}
+
+void IoTHAPulseCounterWrapper::setUnits(const char* totalUnit, const char* rateUnit)
+{
+    _totalUnit = totalUnit;
+    _rateUnit  = rateUnit;
+    _totalSensor.setUnitOfMeasurement(totalUnit);
+    _rateSensor.setUnitOfMeasurement(rateUnit);
+}
+
+void IoTHAPulseCounterWrapper::setDeviceClasses(const char* totalClass, const char* rateClass)
+{
+    _totalSensor.setDeviceClass(totalClass);
+    _rateSensor.setDeviceClass(rateClass);
+}
+
+void IoTHAPulseCounterWrapper::begin()
+{
+    _settings.read();
+    _total = _settings.total();
+
+    RtcRecord r;
+    if (_rtcSlot < MAX_COUNTERS
+        && IoTRtcMemory::read(IoTRtcMemory::PULSE_COUNTER_BLOCK + _rtcSlot * RECORD_BLOCKS, &r, sizeof(r))
+        && r.magic == RTC_MAGIC
+        && r.checksum == IoTRtcMemory::checksum(&r.total, sizeof(r.total))
+        && r.total > _total)
+    {
+        _total = r.total;   // pulses counted after the last NVS save
+    }
+    _savedMs = millis();
+    char total[22];
+    formatDecimal(_total, 0, total);
+    IOTLOGINFO1(F("Pulse counter total: "), total);
+
+    pinMode(_pin, _risingEdge ? INPUT : INPUT_PULLUP);
+    attachInterruptArg(digitalPinToInterrupt(_pin), onPulse, this, _risingEdge ? RISING : FALLING);
+}
+
+void IRAM_ATTR IoTHAPulseCounterWrapper::onPulse(void* arg)
+{
+    IoTHAPulseCounterWrapper* self = static_cast<IoTHAPulseCounterWrapper*>(arg);
+    const uint32_t now = micros();
+    if (self->_minIntervalUs != 0
+        && now - self->_isrLastUs.load(std::memory_order_relaxed) < self->_minIntervalUs)
+    {
+        self->_glitches.store(self->_glitches.load(std::memory_order_relaxed) + 1,
+                              std::memory_order_relaxed);
+        return;
+    }
+
+    // Odd sequence while the pair is being written, see snapshot()
+    const uint32_t seq = self->_seq.load(std::memory_order_relaxed);
+    self->_seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_signal_fence(std::memory_order_release);
+    self->_isrCount.store(self->_isrCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    self->_isrLastUs.store(now, std::memory_order_relaxed);
+    self->_seq.store(seq + 2, std::memory_order_release);
+}
+
+void IoTHAPulseCounterWrapper::snapshot(uint32_t& count, uint32_t& lastUs) const
+{
+    for (;;)
+    {
+        const uint32_t seq = _seq.load(std::memory_order_acquire);
+        count  = _isrCount.load(std::memory_order_relaxed);
+        lastUs = _isrLastUs.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!(seq & 1) && _seq.load(std::memory_order_relaxed) == seq)
+        {
+            return;
+        }
+    }
+}
+
+void IoTHAPulseCounterWrapper::accumulate()
+{
+    uint32_t count, lastUs;
+    snapshot(count, lastUs);
+    const uint32_t delta = count - _seenCount;
+    _seenCount = count;
+
+    // milli-units per rate period for n pulses over us microseconds
+    auto rate = [this](uint32_t n, uint32_t us) {
+        return clampMilli(static_cast<uint64_t>(n) * _ratePeriodS * 1000000000ULL
+                          / (static_cast<uint64_t>(us ? us : 1) * _pulsesPerUnit));
+    };
+
+    if (delta == 0)
+    {
+        if (!_havePulse)
+        {
+            return;
+        }
+        if (millis() - _lastPulseMs >= RATE_TIMEOUT_MS)
+        {
+            _rateMilli = 0;
+            _havePulse = false;
+            return;
+        }
+        // No pulse yet: the rate is at most one pulse over the time since the last
+        const int32_t bound = rate(1, micros() - _prevPulseUs);
+        if (bound < _rateMilli)
+        {
+            _rateMilli = bound;
+        }
+        return;
+    }
+
+    _total += delta;
+    if (_havePulse)
+    {
+        _rateMilli = rate(delta, lastUs - _prevPulseUs);
+    }
+    _prevPulseUs = lastUs;
+    _lastPulseMs = millis();
+    _havePulse   = true;
+}
+
+bool IoTHAPulseCounterWrapper::update(bool force)
+{
+    const uint64_t previous = _total;
+    accumulate();
+    if (_total != previous)
+    {
+        writeRtc();
+    }
+
+    if (_total != _settings.total() && millis() - _savedMs >= _saveIntervalMs)
+    {
+        _settings.setTotal(_total);
+        if (_settings.save())
+        {
+            ++_saves;
+        }
+        _savedMs = millis();
+    }
+    return true;
+}
+
+void IoTHAPulseCounterWrapper::writeRtc() const
+{
+    if (_rtcSlot >= MAX_COUNTERS)
+    {
+        return;
+    }
+    uint32_t count, lastUs;
+    snapshot(count, lastUs);
+
+    RtcRecord r;
+    r.magic    = RTC_MAGIC;
+    r.total    = _total + (count - _seenCount);
+    r.checksum = IoTRtcMemory::checksum(&r.total, sizeof(r.total));
+    IoTRtcMemory::write(IoTRtcMemory::PULSE_COUNTER_BLOCK + _rtcSlot * RECORD_BLOCKS, &r, sizeof(r));
+}
+
+void IoTHAPulseCounterWrapper::onSystemEvent(const IoTSystemEvent& event)
+{
+    // Runs right before the reboot, possibly outside loop(): no NVS write,
+    // RTC memory keeps the pulses counted since the last update()
+    writeRtc();
+}
+
+HANumeric IoTHAPulseCounterWrapper::milli(int64_t value)
+{
+    HANumeric numeric;
+    numeric.setBaseValue(value);
+    numeric.setPrecision(3);
+    return numeric;
+}
+
+int32_t IoTHAPulseCounterWrapper::clampMilli(uint64_t value)
+{
+    return value > static_cast<uint64_t>(INT32_MAX) ? INT32_MAX : static_cast<int32_t>(value);
+}
+
+void IoTHAPulseCounterWrapper::formatDecimal(uint64_t value, uint8_t decimals, char* buf)
+{
+    // Digits in reverse, then copied out; no 64-bit printf on all cores
+    char rev[21];
+    uint8_t n = 0;
+    do
+    {
+        rev[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0 || n <= decimals);
+
+    uint8_t out = 0;
+    while (n > 0)
+    {
+        if (n == decimals)
+        {
+            buf[out++] = '.';
+        }
+        buf[out++] = rev[--n];
+    }
+    buf[out] = '\0';
+}
+
+bool IoTHAPulseCounterWrapper::publishValue(const bool force)
+{
+    const bool totalSent = _totalSensor.setValue(milli(totalMilli()), force);
+    const bool rateSent  = _rateSensor.setValue(milli(_rateMilli), force);
+    return totalSent && rateSent;
+}
+
+String IoTHAPulseCounterWrapper::statusJSON() const
+{
+    auto entry = [](const char* name, const char* value, const char* unit) {
+        const bool hasName = name && name[0] != '\0';
+        String obj;
+        if (hasName)
+        {
+            obj += JSONUtils::Pair(F("name"), name, true);
+        }
+        obj += JSONUtils::Pair(F("value"), value, !hasName);
+        if (unit)
+        {
+            obj += JSONUtils::Pair(F("unit"), unit);
+        }
+        return JSONUtils::EncloseObject(obj);
+    };
+    char total[22];
+    formatDecimal(static_cast<uint64_t>(totalMilli()), 3, total);
+    char rate[IoTFixedPoint<3>::MAX_CHARS];
+    IoTFixedPoint<3>::fromRaw(_rateMilli).toChars(rate, sizeof(rate));
+    return entry(_totalName, total, _totalUnit)
+        + ',' + entry(_rateName, rate, _rateUnit);
+}
+
+#endif // WM_SUPPORT_HOME_ASSISTANT
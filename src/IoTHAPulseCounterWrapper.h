@@ -0,0 +1,214 @@
+/*
+  IoTHAPulseCounterWrapper.h - HA wrapper for an S0 pulse counter (energy, water).
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef IOTHAPULSECOUNTERWRAPPER_H
+#define IOTHAPULSECOUNTERWRAPPER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "IoTHADeviceWrapperBase.h"
+#include "IoTRtcMemory.h"
+#include "Settings.h"
+
+#ifdef WM_SUPPORT_HOME_ASSISTANT
+
+#ifndef IOT_PULSE_SAVE_INTERVAL_MS
+    #define IOT_PULSE_SAVE_INTERVAL_MS (60UL * 60 * 1000)
+#endif
+
+/**
+ * @brief Pulse totals in NVS namespace "PULSE", one key per counter.
+ */
+class IoTPulseCounterSettings : public Settings
+{
+public:
+    explicit IoTPulseCounterSettings(const char* uid);
+
+    uint64_t total() const { return _total; }
+    void setTotal(uint64_t total) { updateValue(total, _total); }
+
+protected:
+    void readFields(Preferences& pref) override;
+    bool saveFields(Preferences& pref) const override;
+
+private:
+    char     _key[10];   ///< "T" + FNV-1a of the uid in hex, NVS keys are <= 15 chars
+    uint64_t _total = 0;
+};
+
+/**
+ * @class IoTHAPulseCounterWrapper
+ * @brief Counts meter pulses (S0 output of energy/water meters) in an ISR and
+ *        publishes the cumulative total and the current rate as HA sensors.
+ *
+ * The ISR only increments a counter and stores the pulse time, under a
+ * sequence number so update() takes a consistent snapshot without disabling
+ * interrupts; this keeps up with pulse rates in the kHz range. update()
+ * derives:
+ *  - total: pulses / pulsesPerUnit (e.g. kWh), state class total_increasing
+ *  - rate:  units per ratePeriodS (default 3600 s, i.e. kWh -> kW), from the
+ *           time between the last pulses of consecutive updates, so a slow
+ *           meter is not quantised by the update interval
+ *
+ * Persistence with few flash writes: the total goes to RTC memory on every
+ * update (survives resets and OTA, not power loss) and to NVS at most every
+ * IOT_PULSE_SAVE_INTERVAL_MS, and only if it changed. After a power cut up to
+ * one save interval of pulses is lost. Up to MAX_COUNTERS counters keep their
+ * total in RTC memory.
+ *
+ * Example:
+ * @code
+ *   IoTHAPulseCounterWrapper m_meter(D6, "energy", "power", 1000);   // 1000 imp/kWh
+ *
+ *   // In postSetup():
+ *   m_meter.setNames("Energy", "Power");
+ *   m_meter.setUnits("kWh", "kW");
+ *   m_meter.setDeviceClasses("energy", "power");
+ * @endcode
+ */
+class IoTHAPulseCounterWrapper : public IoTHADeviceWrapperBase
+{
+public:
+    static constexpr uint8_t  RECORD_BLOCKS = 4;
+    static constexpr uint8_t  MAX_COUNTERS  = IoTRtcMemory::PULSE_COUNTER_BLOCKS / RECORD_BLOCKS;
+
+    /** Rate drops to 0 when no pulse arrived for this long. */
+    static constexpr uint32_t RATE_TIMEOUT_MS = 10UL * 60 * 1000;
+
+    /**
+     * @param pin               GPIO input with interrupt support.
+     * @param totalUid          Unique HA entity ID of the total.
+     * @param rateUid           Unique HA entity ID of the rate.
+     * @param pulsesPerUnit     Meter constant, e.g. 1000 imp/kWh.
+     * @param minPulseIntervalUs Pulses closer than this are dropped as glitches (0 = off).
+     * @param risingEdge        Count rising instead of falling edges (S0 pulls low).
+     */
+    IoTHAPulseCounterWrapper(uint8_t pin, const char* totalUid, const char* rateUid,
+                             uint32_t pulsesPerUnit, uint32_t minPulseIntervalUs = 0,
+                             bool risingEdge = false);
+
+    IoTHAPulseCounterWrapper(const IoTHAPulseCounterWrapper&)            = delete;
+    IoTHAPulseCounterWrapper& operator=(const IoTHAPulseCounterWrapper&) = delete;
+
+    ~IoTHAPulseCounterWrapper() override { detachInterrupt(digitalPinToInterrupt(_pin)); }
+
+    void setNames(const char* totalName, const char* rateName);
+    void setUnits(const char* totalUnit, const char* rateUnit);
+    void setDeviceClasses(const char* totalClass, const char* rateClass);
+
+    /** @brief Rate is reported in units per periodS seconds. Default: 3600. */
+    void setRatePeriod(uint32_t periodS) { _ratePeriodS = periodS; }
+
+    /** @brief Minimum time between NVS writes. Default: IOT_PULSE_SAVE_INTERVAL_MS. */
+    void setSaveInterval(uint32_t intervalMs) { _saveIntervalMs = intervalMs; }
+
+    /** @brief Cumulative pulse count, including the persisted total. */
+    uint64_t totalPulses() const { return _total; }
+
+    /** @brief Pulses dropped by the minimum interval filter. */
+    uint32_t glitchCount() const { return _glitches.load(std::memory_order_relaxed); }
+
+    /** @brief NVS writes since boot. */
+    uint32_t saveCount() const { return _saves; }
+
+    // -----------------------------------------------------------------------
+    // IoTHADeviceWrapperBase
+    // -----------------------------------------------------------------------
+
+    /** @brief Fold new pulses into the total, derive the rate, persist. */
+    bool update(bool force = false) override;
+
+    bool publishValue(const bool force = false) override;
+
+    /** @brief {"name":..,"value":..,"unit":..} for total and rate. */
+    String statusJSON() const override;
+
+    /** @brief Keep the latest total in RTC memory across the reboot. */
+    void onSystemEvent(const IoTSystemEvent& event) override;
+
+    uint32_t systemEventMask() const override
+    {
+        return IoTSystemEvent::maskOf(IoTSystemEvent::Type::RESTARTING);
+    }
+
+protected:
+    /** @brief Restore the total (RTC if valid, else NVS) and attach the ISR. */
+    void begin() override;
+
+private:
+    static constexpr uint32_t RTC_MAGIC = 0x50434E31UL; // "PCN1"
+
+    struct RtcRecord
+    {
+        uint32_t magic;
+        uint32_t checksum;
+        uint64_t total;
+    };
+    static_assert(sizeof(RtcRecord) == RECORD_BLOCKS * 4, "RtcRecord must fill its RTC blocks");
+
+    static void IRAM_ATTR onPulse(void* arg);
+
+    // Consistent {count, last pulse time} pair written by the ISR
+    void snapshot(uint32_t& count, uint32_t& lastUs) const;
+
+    void accumulate();
+    void writeRtc() const;
+    int64_t totalMilli() const { return static_cast<int64_t>(_total * 1000 / _pulsesPerUnit); }
+    static HANumeric milli(int64_t value);
+    static int32_t   clampMilli(uint64_t value);
+    // Decimal text of value / 10^decimals; buf needs 22 bytes
+    static void formatDecimal(uint64_t value, uint8_t decimals, char* buf);
+
+    HASensorNumber _totalSensor;
+    HASensorNumber _rateSensor;
+    uint8_t        _pin;
+    bool           _risingEdge;
+    uint8_t        _rtcSlot;          ///< MAX_COUNTERS = no RTC record
+    uint32_t       _pulsesPerUnit;
+    uint32_t       _minIntervalUs;
+    uint32_t       _ratePeriodS    = 3600;
+    uint32_t       _saveIntervalMs = IOT_PULSE_SAVE_INTERVAL_MS;
+    const char*    _totalName = nullptr;
+    const char*    _rateName  = nullptr;
+    const char*    _totalUnit = nullptr;
+    const char*    _rateUnit  = nullptr;
+
+    // ISR side
+    std::atomic<uint32_t> _seq{0};
+    std::atomic<uint32_t> _isrCount{0};
+    std::atomic<uint32_t> _isrLastUs{0};
+    std::atomic<uint32_t> _glitches{0};
+
+    // loop() side
+    uint64_t _total        = 0;
+    uint32_t _seenCount    = 0;
+    uint32_t _prevPulseUs  = 0;
+    bool     _havePulse    = false;
+    uint32_t _lastPulseMs  = 0;
+    int32_t  _rateMilli    = 0;       ///< units per period * 1000
+    uint32_t _savedMs      = 0;
+    uint32_t _saves        = 0;
+    IoTPulseCounterSettings _settings;
+
+    inline static uint8_t s_counterCount = 0;
+};
+
+#endif // WM_SUPPORT_HOME_ASSISTANT
+
+#endif // IOTHAPULSECOUNTERWRAPPER_H
@@ -0,0 +1,398 @@
+/*
+  IoTHASensorNumberArrayWrapper.h - Homogeneous array of Home Assistant number sensors
+  stored as a structure of arrays.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef IOTHASENSORNUMBERARRAYWRAPPER_H
+#define IOTHASENSORNUMBERARRAYWRAPPER_H
+
+#include <Arduino.h>
+#include <type_traits>
+#include <utility>
+#include "IoTHADeviceWrapperBase.h"
+#include "JSONUtils.h"
+
+/**
+ * @brief Compact per-channel descriptor for IoTHASensorNumberArrayWrapper.
+ *
+ * Keep the descriptor table in a static const array of the device class; the
+ * wrapper only stores a pointer to it.
+ */
+struct IoTHASensorChannel
+{
+    /**
+     * @brief Unique HA entity ID of the channel. It must be unique within your device.
+     */
+    const char* uniqueId;
+
+    /**
+     * @brief Display name of the channel in Home Assistant. It can be nullptr.
+     */
+    const char* name;
+};
+
+/**
+ * @class IoTHASensorNumberArrayWrapper
+ * @brief Home Assistant wrapper for N numeric channels of the same type.
+ *
+ * Intended for high-channel-count hardware (multiplexed ADC boards, 1-Wire buses
+ * with dozens of probes) where NCompositeWrapper<IoTHASensorNumberWrapper<T>, N>
+ * would expand into N full wrapper objects. This class registers as a single
+ * component and keeps per-channel state in contiguous arrays:
+ *
+ *   - current values       T[N]
+ *   - last published value T[N]
+ *   - deadbands            T[N]
+ *   - publish timestamps   uint32_t[N]
+ *
+ * Only the HASensorNumber entities themselves remain per channel, because each
+ * channel is a separate entity in Home Assistant. Every channel therefore also
+ * takes one slot in HAMqtt's entity registry: raise IOT_MAX_HA_DEVICE_TYPES to
+ * cover all entities of the device. RAM_PER_CHANNEL gives the per-channel cost.
+ *
+ * A channel is published when it has a value and either it was never published,
+ * it moved by more than its deadband since the last publish, or the optional
+ * maximum publish interval has elapsed.
+ *
+ * Example — a 32-channel multiplexed ADC:
+ * @code
+ *   static const IoTHASensorChannel kAdcChannels[32] = {
+ *       {"adc_00", "ADC 0"}, {"adc_01", "ADC 1"}, ...
+ *   };
+ *
+ *   // Build with -DIOT_MAX_HA_DEVICE_TYPES=40 (32 channels + other entities)
+ *   IoTHASensorNumberArrayWrapper<float, 32> m_adc{kAdcChannels,
+ *       HABaseDeviceType::PrecisionP2};
+ *
+ *   // In constructor:
+ *   registerComponent(m_adc);
+ *
+ *   // In postSetup():
+ *   m_adc.setUnitOfMeasurement("V");
+ *   m_adc.setAllDeadbands(0.01f);
+ *
+ *   // In update() of the owning code:
+ *   float samples[32];
+ *   readAllChannels(samples);
+ *   m_adc.setValues(samples, 32);
+ * @endcode
+ *
+ * @tparam T  The numeric type of the channel values (e.g. int, float).
+ * @tparam N  Number of channels.
+ */
+template<typename T, size_t N>
+class IoTHASensorNumberArrayWrapper : public IoTHADeviceWrapperBase
+{
+    static_assert(N > 0, "IoTHASensorNumberArrayWrapper: N must be greater than zero.");
+    static_assert(std::is_arithmetic<T>::value,
+        "IoTHASensorNumberArrayWrapper: T must be an arithmetic type.");
+    static_assert(N <= IOT_MAX_HA_DEVICE_TYPES,
+        "IoTHASensorNumberArrayWrapper: N exceeds IOT_MAX_HA_DEVICE_TYPES, HAMqtt would drop channels.");
+
+public:
+    /** Number of channels in this array. */
+    static constexpr size_t SIZE = N;
+
+    /** RAM per channel in bytes: the HA entity plus value, published value, deadband and timestamp. */
+    static constexpr size_t RAM_PER_CHANNEL = sizeof(HASensorNumber) + 3 * sizeof(T) + sizeof(uint32_t);
+
+    /**
+     * @brief Construct the array wrapper.
+     *
+     * @param channels   Descriptor table with exactly N entries. Must outlive the wrapper.
+     * @param precision  The precision of the floating point number displayed in the HA panel.
+     * @param features   Bitmask of features to enable for every channel.
+     */
+    IoTHASensorNumberArrayWrapper(
+        const IoTHASensorChannel (&channels)[N],
+        const HABaseDeviceType::NumberPrecision precision = HABaseDeviceType::PrecisionP0,
+        const uint16_t features = HASensor::DefaultFeatures
+    )
+        : IoTHASensorNumberArrayWrapper(channels, precision, features, std::make_index_sequence<N>{})
+    {}
+
+    IoTHASensorNumberArrayWrapper(const IoTHASensorNumberArrayWrapper&)            = delete;
+    IoTHASensorNumberArrayWrapper& operator=(const IoTHASensorNumberArrayWrapper&) = delete;
+
+    // -----------------------------------------------------------------------
+    // Values
+    // -----------------------------------------------------------------------
+
+    /**
+     * @brief Set the current value of one channel. Out-of-range indexes are ignored.
+     */
+    void setValue(size_t index, T value)
+    {
+        if (index >= N) return;
+        _values[index] = value;
+        setFlag(_hasValue, index);
+    }
+
+    /**
+     * @brief Set current values of n consecutive channels starting at first.
+     *        Values beyond the last channel are ignored.
+     */
+    void setValues(const T* values, size_t n, size_t first = 0)
+    {
+        if (first >= N) return;
+        if (n > N - first) n = N - first;
+        for (size_t i = 0; i < n; ++i)
+        {
+            _values[first + i] = values[i];
+            setFlag(_hasValue, first + i);
+        }
+    }
+
+    /**
+     * @brief Mark a channel as having no value (e.g. a sensor fault).
+     *        The channel is skipped by publishValue() until a new value is set.
+     */
+    void clearValue(size_t index)
+    {
+        if (index < N) clearFlag(_hasValue, index);
+    }
+
+    /** @brief Return the current value of a channel (T{} when out of range). */
+    T value(size_t index) const { return (index < N) ? _values[index] : T{}; }
+
+    /** @brief Return true if the channel holds a value. */
+    bool hasValue(size_t index) const { return index < N && testFlag(_hasValue, index); }
+
+    /** @brief Return the value that was last published for the channel. */
+    T publishedValue(size_t index) const { return (index < N) ? _published[index] : T{}; }
+
+    /** @brief Return millis() timestamp of the last successful publish of the channel. */
+    uint32_t lastPublishedMs(size_t index) const { return (index < N) ? _publishedAtMs[index] : 0; }
+
+    // -----------------------------------------------------------------------
+    // Publish policy
+    // -----------------------------------------------------------------------
+
+    /**
+     * @brief Set the deadband of one channel. A value that differs from the last
+     *        published value by no more than the deadband is not republished.
+     */
+    void setDeadband(size_t index, T deadband)
+    {
+        if (index < N) _deadbands[index] = deadband;
+    }
+
+    /**
+     * @brief Set deadbands of n consecutive channels starting at first.
+     */
+    void setDeadbands(const T* deadbands, size_t n, size_t first = 0)
+    {
+        if (first >= N) return;
+        if (n > N - first) n = N - first;
+        for (size_t i = 0; i < n; ++i)
+            _deadbands[first + i] = deadbands[i];
+    }
+
+    /** @brief Set the same deadband for all channels. */
+    void setAllDeadbands(T deadband)
+    {
+        for (size_t i = 0; i < N; ++i)
+            _deadbands[i] = deadband;
+    }
+
+    /**
+     * @brief Republish a channel after this interval even if it stayed within its deadband.
+     *        0 (default) disables periodic republishing.
+     */
+    void setMaxPublishInterval(uint32_t intervalMs) { _maxPublishIntervalMs = intervalMs; }
+
+    // -----------------------------------------------------------------------
+    // HA entity configuration — applied to every channel
+    // -----------------------------------------------------------------------
+
+    /**
+     * Sets class of the device for all channels.
+     * You can find list of available values here: https://www.home-assistant.io/integrations/sensor/#device-class
+     */
+    void setDeviceClass(const char* deviceClass)
+    {
+        for (size_t i = 0; i < N; ++i) _sensors[i].setDeviceClass(deviceClass);
+    }
+
+    /**
+     * Sets class of the state for the long term stats for all channels.
+     * See: https://developers.home-assistant.io/docs/core/entity/sensor/#long-term-statistics
+     */
+    void setStateClass(const char* stateClass)
+    {
+        for (size_t i = 0; i < N; ++i) _sensors[i].setStateClass(stateClass);
+    }
+
+    /**
+     * Forces HA panel to process each incoming value (MQTT message) of all channels.
+     */
+    void setForceUpdate(bool forceUpdate)
+    {
+        for (size_t i = 0; i < N; ++i) _sensors[i].setForceUpdate(forceUpdate);
+    }
+
+    /**
+     * Sets icon of all channels.
+     * Any icon from MaterialDesignIcons.com (for example: `mdi:home`).
+     */
+    void setIcon(const char* icon)
+    {
+        for (size_t i = 0; i < N; ++i) _sensors[i].setIcon(icon);
+    }
+
+    /**
+     * Defines the units of measurement of all channels.
+     *
+     * @param units For example: °C, %
+     */
+    void setUnitOfMeasurement(const char* unitOfMeasurement)
+    {
+        _unitOfMeasurement = unitOfMeasurement;
+        for (size_t i = 0; i < N; ++i) _sensors[i].setUnitOfMeasurement(unitOfMeasurement);
+    }
+
+    const char* unitOfMeasurement() const { return _unitOfMeasurement; }
+
+    /** @brief Return the descriptor of a channel (nullptr when out of range). */
+    const IoTHASensorChannel* channel(size_t index) const { return (index < N) ? &_channels[index] : nullptr; }
+
+    /**
+     * @brief Direct access to the HA entity of a channel for per-channel configuration.
+     * @return nullptr when out of range
+     */
+    HASensorNumber* sensor(size_t index) { return (index < N) ? &_sensors[index] : nullptr; }
+
+    // -----------------------------------------------------------------------
+    // IoTHADeviceWrapperBase
+    // -----------------------------------------------------------------------
+
+    /**
+     * @brief Publish every channel whose value is due according to the deadband
+     *        and maximum publish interval.
+     *
+     * @param force  Pass true to publish every channel that holds a value.
+     * @return true if every attempted publish succeeded.
+     */
+    bool publishValue(const bool force = false) override
+    {
+        const uint32_t now = millis();
+        bool allOk = true;
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (!testFlag(_hasValue, i)) continue;
+            if (!force && !isPublishDue(i, now)) continue;
+
+            // The deadband decision is made here, so always force the entity.
+            if (_sensors[i].setValue(_values[i], true))
+            {
+                _published[i]     = _values[i];
+                _publishedAtMs[i] = now;
+                setFlag(_wasPublished, i);
+            }
+            else
+            {
+                allOk = false;
+            }
+        }
+        return allOk;
+    }
+
+    /**
+     * @brief Return one {"name":...,"value":...,"unit":...} object per channel
+     *        that holds a value.
+     */
+    String statusJSON() const override
+    {
+        String s;
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (!testFlag(_hasValue, i)) continue;
+            const char* nm = _channels[i].name ? _channels[i].name : _channels[i].uniqueId;
+            String obj;
+            obj += JSONUtils::Pair(F("name"), nm, true);
+            obj += JSONUtils::Pair(F("value"), formatValue(_values[i]));
+            if (_unitOfMeasurement)
+            {
+                obj += JSONUtils::Pair(F("unit"), _unitOfMeasurement);
+            }
+            if (!s.isEmpty()) s += ',';
+            s += JSONUtils::EncloseObject(obj);
+        }
+        return s;
+    }
+
+private:
+    template<size_t... Is>
+    IoTHASensorNumberArrayWrapper(
+        const IoTHASensorChannel (&channels)[N],
+        const HABaseDeviceType::NumberPrecision precision,
+        const uint16_t features,
+        std::index_sequence<Is...>
+    )
+        : _sensors{ HASensorNumber(channels[Is].uniqueId, precision, features)... }
+        , _channels(channels)
+        , _precision(static_cast<uint8_t>(precision))
+    {
+        for (size_t i = 0; i < N; ++i)
+        {
+            if (channels[i].name)
+                _sensors[i].setName(channels[i].name);
+        }
+    }
+
+    bool isPublishDue(size_t i, uint32_t now) const
+    {
+        if (!testFlag(_wasPublished, i))
+            return true;
+        const T delta = (_values[i] > _published[i]) ? _values[i] - _published[i]
+                                                     : _published[i] - _values[i];
+        if (delta > _deadbands[i])
+            return true;
+        return _maxPublishIntervalMs != 0 && (now - _publishedAtMs[i]) >= _maxPublishIntervalMs;
+    }
+
+    String formatValue(T value) const
+    {
+        if constexpr (std::is_floating_point<T>::value)
+            return String(static_cast<float>(value), _precision);
+        else if constexpr (std::is_signed<T>::value)
+            return String(static_cast<long>(value));
+        else
+            return String(static_cast<unsigned long>(value));
+    }
+
+    static bool testFlag(const uint8_t* bits, size_t i) { return bits[i >> 3] & (1u << (i & 7)); }
+    static void setFlag(uint8_t* bits, size_t i)        { bits[i >> 3] |= (1u << (i & 7)); }
+    static void clearFlag(uint8_t* bits, size_t i)      { bits[i >> 3] &= ~(1u << (i & 7)); }
+
+    static constexpr size_t FLAG_BYTES = (N + 7) / 8;
+
+    HASensorNumber            _sensors[N];
+    T                         _values[N]        = {};
+    T                         _published[N]     = {};
+    T                         _deadbands[N]     = {};
+    uint32_t                  _publishedAtMs[N] = {};
+    uint8_t                   _hasValue[FLAG_BYTES]     = {};
+    uint8_t                   _wasPublished[FLAG_BYTES] = {};
+    const IoTHASensorChannel* _channels;
+    const char*               _unitOfMeasurement    = nullptr;
+    uint32_t                  _maxPublishIntervalMs = 0;
+    uint8_t                   _precision;
+};
+
+#endif // IOTHASENSORNUMBERARRAYWRAPPER_H
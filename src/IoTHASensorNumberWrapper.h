@@ -21,9 +21,44 @@
 #ifndef IOTHASENSORNUMBERWRAPPER_H
 #define IOTHASENSORNUMBERWRAPPER_H
 
+#include <type_traits>
 #include "IoTHADeviceWrapperBase.h"
+#include "IoTFixedPoint.h"
+#include "IoTSampleFilter.h"
+#include "JSONUtils.h"
 
+/**
+ * @brief Maps a wrapper value type to what HASensorNumber::setValue() accepts.
+ *
+ * Plain numeric types are passed through unchanged. IoTFixedPoint<P> is handed
+ * over as an HANumeric whose base value is the raw scaled integer, so no float
+ * conversion happens on the publish path.
+ */
+template<typename T>
+struct IoTSensorNumberTraits
+{
+    static constexpr HABaseDeviceType::NumberPrecision defaultPrecision = HABaseDeviceType::PrecisionP0;
+
+    static const T& toSensorValue(const T& value) { return value; }
+};
+
+template<uint8_t P>
+struct IoTSensorNumberTraits<IoTFixedPoint<P>>
+{
+    static_assert(P <= HABaseDeviceType::PrecisionP3,
+        "IoTSensorNumberTraits: HASensorNumber supports at most 3 decimal places.");
+
+    static constexpr HABaseDeviceType::NumberPrecision defaultPrecision =
+        static_cast<HABaseDeviceType::NumberPrecision>(P);
 
+    static HANumeric toSensorValue(const IoTFixedPoint<P>& value)
+    {
+        HANumeric numeric;
+        numeric.setBaseValue(value.raw());
+        numeric.setPrecision(P);
+        return numeric;
+    }
+};
 
 /**
  * @brief Wrapper class for Home Assistant number sensor integration.
@@ -32,7 +67,11 @@
  * using the HASensorNumber class. It allows you to set and publish numeric values (integer or floating point)
  * to Home Assistant, with support for precision and feature configuration.
  *
- * @tparam T The numeric type of the sensor value (e.g., int, float, double).
+ * For IoTFixedPoint<P> values the whole path — MQTT payload, statusJSON() and
+ * display output — uses integer arithmetic only, which avoids soft-float work on
+ * the ESP8266. The precision is always P; the constructor takes no precision.
+ *
+ * @tparam T The numeric type of the sensor value (e.g., int, float, double, IoTFixedPoint<1>).
  */
 template<typename T>
 class IoTHASensorNumberWrapper : public IoTHADeviceWrapperBase
@@ -42,18 +81,40 @@ public:
      * @brief Construct a new IoTHASensorNumberWrapper object.
      *
      * @param uniqueId The unique ID of the sensor. It must be unique within your device.
-     * @param precision The precision of the floating point number displayed in the HA panel (default: PrecisionP0).
+     * @param precision The precision of the floating point number displayed in the HA panel
+     *                  (default: PrecisionP0).
      * @param features Bitmask of features to enable for the sensor (default: DefaultFeatures).
      */
+    template<typename U = T, typename std::enable_if<!IoTIsFixedPoint<U>::value, int>::type = 0>
     IoTHASensorNumberWrapper(
         const char* uniqueId,
-        const HABaseDeviceType::NumberPrecision precision = HABaseDeviceType::PrecisionP0,
+        const HABaseDeviceType::NumberPrecision precision = IoTSensorNumberTraits<T>::defaultPrecision,
         const uint16_t features = HASensor::DefaultFeatures
     )
         : _sensor(uniqueId, precision, features)
         , _currentValue{}
     {}
 
+    /**
+     * @brief Construct a fixed-point sensor; the precision is P of IoTFixedPoint<P>.
+     *
+     * @param uniqueId The unique ID of the sensor. It must be unique within your device.
+     * @param features Bitmask of features to enable for the sensor (default: DefaultFeatures).
+     */
+    template<typename U = T, typename std::enable_if<IoTIsFixedPoint<U>::value, int>::type = 0>
+    IoTHASensorNumberWrapper(
+        const char* uniqueId,
+        const uint16_t features = HASensor::DefaultFeatures
+    )
+        : _sensor(uniqueId, IoTSensorNumberTraits<T>::defaultPrecision, features)
+        , _currentValue{}
+    {}
+
+    // Without this a precision argument would silently convert to the features bitmask
+    template<typename U = T, typename std::enable_if<IoTIsFixedPoint<U>::value, int>::type = 0>
+    IoTHASensorNumberWrapper(const char* uniqueId, HABaseDeviceType::NumberPrecision precision,
+                             uint16_t features = HASensor::DefaultFeatures) = delete;
+
     /**
      * @brief Publish the current value to Home Assistant.
      *
@@ -62,7 +123,39 @@ public:
      */
     bool publishValue(const bool force = false) override
     {
-        return _sensor.setValue(_currentValue, force);
+        return _sensor.setValue(IoTSensorNumberTraits<T>::toSensorValue(_currentValue), force);
+    }
+
+    /**
+     * @brief Return a {"name":...,"value":...,"unit":...} object for the web status table.
+     *
+     * Only fixed-point sensors report status by default; the value is formatted
+     * with integer arithmetic. Other types return an empty String so existing
+     * devices keep control over their status output.
+     */
+    String statusJSON() const override
+    {
+        if constexpr (IoTIsFixedPoint<T>::value)
+        {
+            char buf[T::MAX_CHARS];
+            _currentValue.toChars(buf, sizeof(buf));
+            bool hasName = _name && _name[0] != '\0';
+            String obj;
+            if (hasName)
+            {
+                obj += JSONUtils::Pair(F("name"), _name, true);
+            }
+            obj += JSONUtils::Pair(F("value"), buf, !hasName);
+            if (_unitOfMeasurement)
+            {
+                obj += JSONUtils::Pair(F("unit"), _unitOfMeasurement);
+            }
+            return JSONUtils::EncloseObject(obj);
+        }
+        else
+        {
+            return String();
+        }
     }
 
     /**
@@ -75,6 +168,11 @@ public:
         _currentValue = value;
     }
 
+    /**
+     * @brief Return the current value of the sensor.
+     */
+    const T& currentValue() const { return _currentValue; }
+
     void setName(const char* name)
     {
         _name = name;
@@ -139,6 +237,52 @@ public:
         _sensor.setUnitOfMeasurement(unitOfMeasurement);
     }
 
+    /**
+     * @brief Changes up to deadband (inclusive) do not count as a change for
+     *        the deep-sleep duty cycle, see IoTDutyCycle. Default: 0.
+     */
+    void setDeadband(T deadband) { _deadband = deadband; }
+
+    uint32_t retainedValue() const override
+    {
+        if constexpr (IoTIsFixedPoint<T>::value)
+        {
+            return static_cast<uint32_t>(_currentValue.raw());
+        }
+        else if constexpr (std::is_floating_point<T>::value)
+        {
+            const float f = static_cast<float>(_currentValue);
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            return bits;
+        }
+        else
+        {
+            return static_cast<uint32_t>(static_cast<int32_t>(_currentValue));
+        }
+    }
+
+    bool changedSince(uint32_t retained) const override
+    {
+        if constexpr (IoTIsFixedPoint<T>::value)
+        {
+            const int32_t diff = _currentValue.raw() - static_cast<int32_t>(retained);
+            return (diff < 0 ? -diff : diff) > _deadband.raw();
+        }
+        else if constexpr (std::is_floating_point<T>::value)
+        {
+            float previous;
+            memcpy(&previous, &retained, sizeof(previous));
+            const float diff = static_cast<float>(_currentValue) - previous;
+            return (diff < 0 ? -diff : diff) > static_cast<float>(_deadband);
+        }
+        else
+        {
+            const int32_t diff = static_cast<int32_t>(_currentValue) - static_cast<int32_t>(retained);
+            return (diff < 0 ? -diff : diff) > static_cast<int32_t>(_deadband);
+        }
+    }
+
 protected:
     /**
      * @brief The underlying Home Assistant number sensor object.
@@ -162,6 +306,53 @@ protected:
      * associated with the sensor's readings.
      */
     const char* _unitOfMeasurement = nullptr;
+
+    /**
+     * @brief Duty-cycle change threshold, see setDeadband().
+     */
+    T _deadband{};
+};
+
+/**
+ * @brief Number sensor that smooths its readings with an IoTSampleFilter.
+ *
+ * Feed every raw reading to addSample() instead of calling setCurrentValue();
+ * the current value follows the filter output.
+ * @code
+ *   IoTHAFilteredSensorNumberWrapper<IoTFixedPoint<1>, IoTMedian<5>, IoTEma<20>> temperature{"temp"};
+ *   temperature.addSample(IoTFixedPoint<1>::fromScaled(milliCelsius, 1000));
+ * @endcode
+ *
+ * @tparam T      - value type, as for IoTHASensorNumberWrapper
+ * @tparam Stages - filter stages applied in order, see IoTSampleFilter
+ */
+template<typename T, typename... Stages>
+class IoTHAFilteredSensorNumberWrapper : public IoTHASensorNumberWrapper<T>
+{
+public:
+    using IoTHASensorNumberWrapper<T>::IoTHASensorNumberWrapper;
+
+    /**
+     * @brief Run a reading through the filter.
+     * @return true if the current value was updated, false if a stage
+     *         (e.g. IoTOversample) is still collecting samples
+     */
+    bool addSample(T sample)
+    {
+        T filtered{};
+        if (!_filter.push(sample, filtered))
+        {
+            return false;
+        }
+        this->setCurrentValue(filtered);
+        return true;
+    }
+
+    /** @brief Drop the filter history, e.g. after the sensor was re-initialised. */
+    void resetFilter() { _filter.reset(); }
+
+private:
+    IoTSampleFilter<T, Stages...> _filter;
 };
 
 #endif // IOTHASENSORNUMBERWRAPPER_H
\ No newline at end of file
@@ -27,6 +27,14 @@
 #include "DeviceDefines.h"   // IOT_MAX_COMPONENTS + LanguageSupport.h → L_GENERAL_ON/OFF
 #include "JSONUtils.h"
 
+#ifndef IOT_SWITCH_HEARTBEAT_MS
+    #define IOT_SWITCH_HEARTBEAT_MS 0   // 0 = no periodic republish
+#endif
+
+#ifndef IOT_MQTT_INBOUND_BATCH
+    #define IOT_MQTT_INBOUND_BATCH 8    // MQTT packets read per loop() pass
+#endif
+
 /**
  * @class IoTHASwitchWrapper
  * @brief HA wrapper for a GPIO-driven on/off switch (LED or relay).
@@ -36,13 +44,26 @@
  * automatically; an optional user callback can handle additional side-effects
  * (e.g. updating an LCD or logging).
  *
+ * MQTT commands are not applied in the MQTT callback. The latest command per
+ * switch is kept and applied by poll() once the loop() pass has read all
+ * waiting MQTT packets (up to IOT_MQTT_INBOUND_BATCH). A burst of commands,
+ * e.g. retained replays or an automation toggling quickly, drives the GPIO and
+ * publishes the state once. Superseded commands are counted in
+ * commandsSupersededCount(). A command matching the current state does not
+ * touch the GPIO but still republishes the state, so a non-optimistic HA
+ * entity that is out of sync gets corrected; it is counted in
+ * commandsConfirmedCount().
+ *
  * Usage pattern:
  *   1. Construct with a GPIO pin, unique HA entity ID, and optional active-high flag.
  *   2. Register with IoTDevice::registerComponent() — begin() is called automatically
  *      by IoTDevice::preSetup().
  *   3. Configure the HA entity (setName, setIcon, etc.) in postSetup().
  *   4. Optionally call onCommand(cb) to hook additional logic.
- *   5. publishAllComponents() in the loop re-publishes the current state to MQTT.
+ *   5. publishAllComponents() in the loop publishes the state to MQTT when it
+ *      has not been published yet (a change that could not be sent), on the
+ *      forced cycle after an MQTT reconnect, or when the heartbeat
+ *      (setHeartbeat()) is due.
  *
  * Example:
  * @code
@@ -126,6 +147,27 @@ public:
     /** @brief Return the current switch state (true = ON). */
     bool getCurrentState() const { return _switch.getCurrentState(); }
 
+    /**
+     * @brief Republish the unchanged state every intervalMs, 0 = never.
+     *        Default: IOT_SWITCH_HEARTBEAT_MS.
+     */
+    void setHeartbeat(uint32_t intervalMs) { _heartbeatMs = intervalMs; }
+
+    /** @brief State messages sent to MQTT by all switches. */
+    static uint32_t publishedCount() { return s_published; }
+
+    /** @brief publishValue() calls of all switches that had nothing to send. */
+    static uint32_t skippedCount() { return s_skipped; }
+
+    /** @brief MQTT commands received by all switches. */
+    static uint32_t commandsReceivedCount() { return s_commandsReceived; }
+
+    /** @brief MQTT commands replaced by a later one in the same loop() pass, never applied. */
+    static uint32_t commandsSupersededCount() { return s_commandsSuperseded; }
+
+    /** @brief MQTT commands equal to the current state: no GPIO write, state republished. */
+    static uint32_t commandsConfirmedCount() { return s_commandsConfirmed; }
+
     /**
      * @brief Register an optional callback invoked after each state change.
      *
@@ -150,16 +192,50 @@ public:
     // IoTHADeviceWrapperBase
     // -----------------------------------------------------------------------
 
+    /** @brief Apply the latest MQTT command received since the last pass. */
+    bool poll() override
+    {
+        if (!_commandPending)
+        {
+            return false;
+        }
+        _commandPending = false;
+        if (_pendingState == _switch.getCurrentState())
+        {
+            // No GPIO write, but confirm the state: HA may be out of sync
+            ++s_commandsConfirmed;
+            ++_stateGeneration;
+            publishState();   // retried by publishValue() if it fails
+            return false;
+        }
+        handleCommand(_pendingState);
+        return true;
+    }
+
+    uint32_t msUntilNextPoll() const override { return _commandPending ? 0 : UINT32_MAX; }
+
     /**
-     * @brief Re-publish the current switch state to MQTT.
-     *        Called by IoTDevice::publishAllComponents() on each cycle.
+     * @brief Publish the switch state to MQTT if it is not published yet or
+     *        the heartbeat is due. Called by IoTDevice::publishAllComponents()
+     *        on each cycle.
+     *
+     * Changes are published right away by the command handler, so this only
+     * retries failed sends, sends the heartbeat and republishes on a forced
+     * cycle. IoTApplication forces the cycle that follows an MQTT reconnect,
+     * when the broker may have lost the state.
      *
-     * @param force  Pass true to publish even if the state has not changed.
-     * @return true if the MQTT message was sent successfully.
+     * @param force  Republish even if the published state is up to date.
+     * @return true if the published state is up to date.
      */
     bool publishValue(const bool force = false) override
     {
-        return _switch.setState(_switch.getCurrentState(), force);
+        const bool heartbeatDue = _heartbeatMs != 0 && millis() - _publishedMs >= _heartbeatMs;
+        if (!force && _publishedGeneration == _stateGeneration && !heartbeatDue)
+        {
+            ++s_skipped;
+            return true;
+        }
+        return publishState();
     }
 
     /**
@@ -197,6 +273,7 @@ protected:
         pinMode(_pin, OUTPUT);
         applyState(false);
         _switch.setCurrentState(false);
+        ++_stateGeneration;
     }
 
 private:
@@ -209,18 +286,45 @@ private:
     {
         applyState(state);
         _switch.setCurrentState(state);   // update regardless of MQTT connection
-        _switch.setState(state, true);    // attempt MQTT publish (force bypasses equality check)
+        ++_stateGeneration;
+        publishState();                   // retried by publishValue() if it fails
         if (_callback)
             _callback(state, this);
     }
 
+    bool publishState()
+    {
+        const uint16_t generation = _stateGeneration;
+        // force bypasses HASwitch's equality check against the state set above
+        if (!_switch.setState(_switch.getCurrentState(), true))
+        {
+            return false;
+        }
+        _publishedGeneration = generation;
+        _publishedMs         = millis();
+        ++s_published;
+        return true;
+    }
+
+    // Latest command wins, poll() applies it
+    void queueCommand(bool state)
+    {
+        if (_commandPending)
+        {
+            ++s_commandsSuperseded;
+        }
+        _pendingState   = state;
+        _commandPending = true;
+    }
+
     static void onSwitchCommand(bool state, HASwitch* sender)
     {
+        ++s_commandsReceived;
         for (uint8_t i = 0; i < s_instanceCount; ++i)
         {
             if (&s_instances[i]->_switch == sender)
             {
-                s_instances[i]->handleCommand(state);
+                s_instances[i]->queueCommand(state);
                 return;
             }
         }
@@ -233,6 +337,22 @@ private:
     const char*     _name     = nullptr;
     CommandCallback _callback = nullptr;
 
+    // Bumped on every state change; published once equal
+    uint16_t        _stateGeneration     = 0;
+    uint16_t        _publishedGeneration = 0;
+    uint32_t        _publishedMs         = 0;
+    uint32_t        _heartbeatMs         = IOT_SWITCH_HEARTBEAT_MS;
+
+    // MQTT command waiting for poll()
+    bool            _commandPending      = false;
+    bool            _pendingState        = false;
+
+    inline static uint32_t s_published        = 0;
+    inline static uint32_t s_skipped          = 0;
+    inline static uint32_t s_commandsReceived   = 0;
+    inline static uint32_t s_commandsSuperseded = 0;
+    inline static uint32_t s_commandsConfirmed  = 0;
+
     // Static registry — bridges the plain HASwitch callback to the owning wrapper.
     // Sized by IOT_MAX_COMPONENTS (defined in DeviceDefines.h, default 8).
     inline static IoTHASwitchWrapper* s_instances[IOT_MAX_COMPONENTS] = {};
@@ -0,0 +1,104 @@
+/*
+  IoTHttpAdmission.cpp - Admission control for the async web server.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "IoTHttpAdmission.h"
+#include "IoTDebug.h"
+
+IoTHttpAdmission::RouteClass IoTHttpAdmission::classify(const String& url)
+{
+    if (url.startsWith(F("/api/events")))
+    {
+        return RouteClass::STREAM;
+    }
+    if (url.startsWith(F("/api/")))
+    {
+        return RouteClass::API;
+    }
+    if (url.startsWith(F("/update")))
+    {
+        return RouteClass::UPLOAD;
+    }
+    if (url.endsWith(F(".js")) || url.endsWith(F(".css"))
+        || url.endsWith(F(".ico")) || url.endsWith(F(".png")))
+    {
+        return RouteClass::STATIC;
+    }
+    return RouteClass::PAGE;
+}
+
+uint8_t IoTHttpAdmission::classLimit(RouteClass rc)
+{
+    switch (rc)
+    {
+        case RouteClass::API:    return 3;
+        case RouteClass::PAGE:   return 2;
+        case RouteClass::STATIC: return 2;
+        case RouteClass::UPLOAD: return 1;
+        default:                 return MAX_INFLIGHT;
+    }
+}
+
+bool IoTHttpAdmission::heapTooLow()
+{
+#if defined(ESP8266)
+    const uint32_t maxBlock = ESP.getMaxFreeBlockSize();
+#elif defined(ESP32)
+    const uint32_t maxBlock = ESP.getMaxAllocHeap();
+#endif
+    return ESP.getFreeHeap() < MIN_FREE_HEAP || maxBlock < MIN_FREE_BLOCK;
+}
+
+bool IoTHttpAdmission::canHandle(AsyncWebServerRequest* request)
+{
+    const RouteClass rc = classify(request->url());
+
+    // A firmware upload is the last thing to turn away for lack of heap
+    if (rc != RouteClass::UPLOAD && heapTooLow())
+    {
+        ++_rejectedHeap;
+        return true;
+    }
+    if (rc == RouteClass::STREAM)
+    {
+        return false;
+    }
+
+    const uint8_t c = static_cast<uint8_t>(rc);
+    if (_inFlight >= MAX_INFLIGHT || _classInFlight[c] >= classLimit(rc))
+    {
+        ++_rejectedBusy;
+        return true;
+    }
+
+    ++_inFlight;
+    ++_classInFlight[c];
+    request->onDisconnect([this, c]() {
+        --_inFlight;
+        --_classInFlight[c];
+    });
+    return false;
+}
+
+void IoTHttpAdmission::handleRequest(AsyncWebServerRequest* request)
+{
+    IOTLOGDEBUG1(F("HTTP request rejected: "), request->url());
+    AsyncWebServerResponse* response = request->beginResponse(503, "text/plain", "Busy, retry later");
+    response->addHeader("Retry-After", String(RETRY_AFTER_S));
+    request->send(response);
+}
@@ -0,0 +1,97 @@
+/*
+  IoTHttpAdmission.h - Admission control for the async web server.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+
+#ifndef IOT_HTTP_MAX_INFLIGHT
+    #define IOT_HTTP_MAX_INFLIGHT 4
+#endif
+
+#ifndef IOT_HTTP_MIN_FREE_HEAP
+    #define IOT_HTTP_MIN_FREE_HEAP 8192
+#endif
+
+#ifndef IOT_HTTP_MIN_FREE_BLOCK
+    #define IOT_HTTP_MIN_FREE_BLOCK 4096
+#endif
+
+/**
+ * @brief First handler of the web server; turns away requests the device
+ *        cannot afford with "503 Service Unavailable" + Retry-After.
+ *
+ * A request is rejected when free heap or the largest free block is below
+ * IOT_HTTP_MIN_FREE_HEAP / IOT_HTTP_MIN_FREE_BLOCK, when IOT_HTTP_MAX_INFLIGHT
+ * requests are already being served, or when its route class has reached its
+ * own limit. Admitted requests are counted until their connection closes
+ * (onDisconnect). Everything runs in the async web server context.
+ *
+ * STREAM requests (/api/events) are not counted: IoTStatusStream caps them
+ * itself and sets its own onDisconnect handler, which would replace ours.
+ * Routes that call request->onDisconnect() must likewise be classified as
+ * STREAM.
+ *
+ * Must be added before any other handler, as the server uses the first
+ * handler that accepts a request.
+ */
+class IoTHttpAdmission : public AsyncWebHandler
+{
+public:
+    enum class RouteClass : uint8_t
+    {
+        API,        ///< /api/*
+        PAGE,       ///< portal pages and system queries
+        STATIC,     ///< .js, .css, images
+        UPLOAD,     ///< firmware update
+        STREAM,     ///< /api/events, capped elsewhere
+        COUNT
+    };
+
+    static constexpr uint8_t  MAX_INFLIGHT    = IOT_HTTP_MAX_INFLIGHT;
+    static constexpr uint32_t MIN_FREE_HEAP   = IOT_HTTP_MIN_FREE_HEAP;
+    static constexpr uint32_t MIN_FREE_BLOCK  = IOT_HTTP_MIN_FREE_BLOCK;
+    static constexpr uint8_t  RETRY_AFTER_S   = 2;
+
+    static RouteClass classify(const String& url);
+
+    /** @brief Requests currently being served (counted classes only). */
+    uint8_t inFlight() const { return _inFlight; }
+
+    /** @brief Requests rejected because too many were in flight. */
+    uint32_t rejectedBusy() const { return _rejectedBusy; }
+
+    /** @brief Requests rejected because of low heap. */
+    uint32_t rejectedHeap() const { return _rejectedHeap; }
+
+    // AsyncWebHandler: canHandle() returns true for requests to reject
+    bool canHandle(AsyncWebServerRequest* request) override;
+    void handleRequest(AsyncWebServerRequest* request) override;
+    bool isRequestHandlerTrivial() override { return true; }
+
+private:
+    static uint8_t classLimit(RouteClass rc);
+    static bool heapTooLow();
+
+    uint8_t  _inFlight = 0;
+    uint8_t  _classInFlight[static_cast<uint8_t>(RouteClass::COUNT)] = {};
+    uint32_t _rejectedBusy = 0;
+    uint32_t _rejectedHeap = 0;
+};
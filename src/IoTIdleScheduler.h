@@ -0,0 +1,161 @@
+/*
+  IoTIdleScheduler.h - Sleep between loop() iterations until the next deadline.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef IOTIDLESCHEDULER_H
+#define IOTIDLESCHEDULER_H
+
+#include <Arduino.h>
+#include <atomic>
+
+#if defined(ESP8266)
+    #include <ESP8266WiFi.h>
+    #include <coredecls.h>  // esp_delay()
+#elif defined(ESP32)
+    #include <WiFi.h>
+#endif
+
+/**
+ * @brief Lets the CPU (and optionally the radio) sleep while loop() has
+ *        nothing to do.
+ *
+ * IoTApplication computes the earliest pending deadline (periodic update,
+ * display refresh, IoTDevice::msUntilNextDeadline()) and calls idle() with
+ * it. idle() yields to the system until then, but checks the pending
+ * predicate every POLL_MS and returns as soon as work arrives (queued web
+ * command, system event, MQTT data, or wake() from an interrupt), so
+ * commands wait at most POLL_MS.
+ *
+ * While idle the SDK runs network, timers and the async web server as usual.
+ * The radio sleep of the policy is applied to the WiFi station by
+ * applyRadioSleep():
+ *  - CPU:          radio always on, only the CPU idles
+ *  - MODEM_SLEEP:  radio off between DTIM beacons (adds up to one DTIM
+ *                  interval of network latency)
+ *  - LIGHT_SLEEP:  ESP8266 also light-sleeps the CPU between beacons; on
+ *                  ESP32 this is modem sleep (automatic light sleep needs
+ *                  esp_pm support not enabled in Arduino builds)
+ */
+class IoTIdleScheduler
+{
+public:
+    enum class Policy : uint8_t
+    {
+        NONE,           ///< loop() spins (default)
+        CPU,
+        MODEM_SLEEP,
+        LIGHT_SLEEP,
+    };
+
+    /** Interval of checking for new work while idle. */
+    static constexpr uint32_t POLL_MS     = 10;
+
+    /** Longest single idle period, keeps housekeeping in loop() going. */
+    static constexpr uint32_t MAX_IDLE_MS = 1000;
+
+    /** Window of the idlePercent() statistic. */
+    static constexpr uint32_t STATS_WINDOW_MS = 60000;
+
+    void setPolicy(Policy policy) { _policy = policy; }
+    Policy policy() const { return _policy; }
+
+    /**
+     * @brief Configure WiFi station power save for the policy. Call after
+     *        WiFi.mode(WIFI_STA).
+     */
+    void applyRadioSleep()
+    {
+        if (_policy == Policy::NONE || _policy == Policy::CPU)
+        {
+            return;
+        }
+#if defined(ESP8266)
+        WiFi.setSleepMode(_policy == Policy::LIGHT_SLEEP ? WIFI_LIGHT_SLEEP : WIFI_MODEM_SLEEP);
+#elif defined(ESP32)
+        WiFi.setSleep(true);
+#endif
+    }
+
+    /**
+     * @brief Sleep for up to ms (at most MAX_IDLE_MS), returning early when
+     *        pending() becomes true. No-op for Policy::NONE.
+     * @param pending - callable bool(), true when loop() has work
+     */
+    template<typename Pending>
+    void idle(uint32_t ms, Pending&& pending)
+    {
+        auto woken = [&pending]() {
+            return s_wake.load(std::memory_order_relaxed) || pending();
+        };
+        if (_policy == Policy::NONE || ms == 0 || woken())
+        {
+            return;
+        }
+        if (ms > MAX_IDLE_MS)
+        {
+            ms = MAX_IDLE_MS;
+        }
+
+        const uint32_t startMs = millis();
+#if defined(ESP8266)
+        esp_delay(ms, [&woken]() { return !woken(); }, POLL_MS);
+#else
+        while (millis() - startMs < ms && !woken())
+        {
+            delay(POLL_MS);
+        }
+#endif
+        account(millis() - startMs);
+    }
+
+    /**
+     * @brief End the current or next idle() early. ISR safe.
+     */
+    static void IRAM_ATTR wake() { s_wake.store(true, std::memory_order_relaxed); }
+
+    /**
+     * @brief Forget earlier wake() calls. Call before collecting the state
+     *        that decides the idle time, so a wake() after it is not lost.
+     */
+    static void clearWake() { s_wake.store(false, std::memory_order_relaxed); }
+
+    /** @brief Share of time spent in idle() over the last full window [%]. */
+    uint8_t idlePercent() const { return _idlePercent; }
+
+private:
+    void account(uint32_t idleMs)
+    {
+        _windowIdleMs += idleMs;
+        const uint32_t windowMs = millis() - _windowStartMs;
+        if (windowMs >= STATS_WINDOW_MS)
+        {
+            _idlePercent   = static_cast<uint8_t>(static_cast<uint64_t>(_windowIdleMs) * 100 / windowMs);
+            _windowStartMs = millis();
+            _windowIdleMs  = 0;
+        }
+    }
+
+    Policy   _policy        = Policy::NONE;
+    uint32_t _windowStartMs = 0;
+    uint32_t _windowIdleMs  = 0;
+    uint8_t  _idlePercent   = 0;
+
+    inline static std::atomic<bool> s_wake{false};
+};
+
+#endif // IOTIDLESCHEDULER_H
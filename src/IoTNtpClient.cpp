@@ -0,0 +1,379 @@
+/*
+  IoTNtpClient.cpp - Non-blocking SNTP client with server selection and drift estimation.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "IoTNtpClient.h"
+#include "IoTDebug.h"
+#include "JSONUtils.h"
+
+#if defined(ESP8266)
+    #include <ESP8266WiFi.h>
+#elif defined(ESP32)
+    #include <WiFi.h>
+    #include <lwip/tcpip.h>
+#endif
+#include <lwip/dns.h>
+
+namespace
+{
+    constexpr uint32_t SEVENTY_YEARS = 2208988800UL;   // 1900 -> 1970
+
+    uint32_t readU32(const uint8_t* p)
+    {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+    }
+
+    // NTP timestamp (seconds since 1900 + 32-bit fraction) -> ms since 1970
+    uint64_t ntpToUnixMs(const uint8_t* p)
+    {
+        const uint64_t seconds  = readU32(p) - SEVENTY_YEARS;
+        const uint64_t fraction = readU32(p + 4);
+        return seconds * 1000 + ((fraction * 1000) >> 32);
+    }
+}
+
+IoTNtpClient::IoTNtpClient(uint32_t syncIntervalMs) :
+    _syncIntervalMs(syncIntervalMs)
+{
+}
+
+bool IoTNtpClient::addServer(const char* host)
+{
+    if (_serverCount >= MAX_SERVERS)
+    {
+        return false;
+    }
+    _servers[_serverCount++].host = host;
+    return true;
+}
+
+void IoTNtpClient::begin()
+{
+    _udp.begin(LOCAL_PORT);
+    _nextSyncMs = millis();
+    _syncRequested = true;
+}
+
+bool IoTNtpClient::loop()
+{
+    switch (_state)
+    {
+        case State::IDLE:
+            if (_serverCount > 0 && isDue() && WiFi.status() == WL_CONNECTED)
+            {
+                _triedMask = 0;
+                startAttempt();
+            }
+            break;
+
+        case State::RESOLVING:
+        {
+            const uint32_t ip = _servers[_current].ip.load();
+            if (ip != 0 && ip != DNS_FAILED)
+            {
+                sendRequest();
+            }
+            else if (ip == DNS_FAILED || millis() - _stateSinceMs >= DNS_TIMEOUT_MS)
+            {
+                IOTLOGWARN1(F("NTP DNS lookup failed:"), _servers[_current].host);
+                failAttempt();
+            }
+            break;
+        }
+
+        case State::WAITING:
+            if (_udp.parsePacket() >= PACKET_SIZE && handleReply())
+            {
+                return true;
+            }
+            if (millis() - _stateSinceMs >= REPLY_TIMEOUT_MS)
+            {
+                IOTLOGWARN1(F("NTP no reply:"), _servers[_current].host);
+                failAttempt();
+            }
+            break;
+    }
+    return false;
+}
+
+uint64_t IoTNtpClient::utcTimeMs() const
+{
+    if (!_timeSet)
+    {
+        return 0;
+    }
+    const int64_t elapsed = millis() - _syncLocalMs;
+    return _syncUtcMs + elapsed - elapsed * _driftPpb / 1000000000LL;
+}
+
+String IoTNtpClient::statusJSON() const
+{
+    String s;
+    for (uint8_t i = 0; i < _serverCount; ++i)
+    {
+        const Server& server = _servers[i];
+        String value;
+        value += server.successes;
+        value += '/';
+        value += server.successes + server.failures;
+        value += F(" ok, rtt ");
+        value += server.srttMs;
+        value += F(" ms");
+        if (i == _activeServer)
+        {
+            value += F(" (active)");
+        }
+
+        if (i > 0) s += ',';
+        String obj;
+        obj += JSONUtils::Pair(F("name"),  server.host, true);
+        obj += JSONUtils::Pair(F("value"), value);
+        s += JSONUtils::EncloseObject(obj);
+    }
+
+    String obj;
+    obj += JSONUtils::Pair(F("name"),  String(F("Drift [ppm]")), true);
+    obj += JSONUtils::Pair(F("value"), String(_driftPpb / 1000.0f, 1));
+    if (_serverCount > 0) s += ',';
+    s += JSONUtils::EncloseObject(obj);
+    return s;
+}
+
+bool IoTNtpClient::isDue() const
+{
+    return _syncRequested || static_cast<int32_t>(millis() - _nextSyncMs) >= 0;
+}
+
+int8_t IoTNtpClient::selectServer() const
+{
+    // Lowest smoothed RTT first; unmeasured servers keep their configured order.
+    int8_t best = -1, second = -1;
+    uint32_t bestScore = UINT32_MAX, secondScore = UINT32_MAX;
+    for (uint8_t i = 0; i < _serverCount; ++i)
+    {
+        if (_triedMask & (1 << i))
+        {
+            continue;
+        }
+        const Server& server = _servers[i];
+        const uint32_t score = (server.srttMs ? server.srttMs : UNMEASURED_RTT_MS + i) +
+                               server.failuresInRow * 1000UL;
+        if (score < bestScore)
+        {
+            second = best; secondScore = bestScore;
+            best = i; bestScore = score;
+        }
+        else if (score < secondScore)
+        {
+            second = i; secondScore = score;
+        }
+    }
+
+    // Keep the RTT of the alternatives current.
+    if (_triedMask == 0 && second >= 0 && _timeSet && _syncCount % PROBE_EVERY == PROBE_EVERY - 1)
+    {
+        return second;
+    }
+    return best;
+}
+
+void IoTNtpClient::startAttempt()
+{
+    _current = selectServer();
+    if (_current < 0)
+    {
+        IOTLOGWARN(F("NTP sync failed on all servers"));
+        _syncRequested = false;
+        _nextSyncMs = millis() + RETRY_MS;
+        setState(State::IDLE);
+        return;
+    }
+    _triedMask |= 1 << _current;
+
+    const uint32_t ip = _servers[_current].ip.load();
+    if (ip != 0 && ip != DNS_FAILED)
+    {
+        sendRequest();
+    }
+    else
+    {
+        startResolve();
+    }
+}
+
+void IoTNtpClient::startResolve()
+{
+    Server& server = _servers[_current];
+    server.ip.store(0);
+
+    ip_addr_t addr;
+#if defined(ESP32) && defined(CONFIG_LWIP_TCPIP_CORE_LOCKING)
+    LOCK_TCPIP_CORE();
+#endif
+    const err_t err = dns_gethostbyname(server.host, &addr,
+        [](const char* name, const ip_addr_t* ipaddr, void* arg) {
+            static_cast<IoTNtpClient*>(arg)->onDnsResult(
+                name, ipaddr ? ip4_addr_get_u32(ip_2_ip4(ipaddr)) : DNS_FAILED);
+        }, this);
+#if defined(ESP32) && defined(CONFIG_LWIP_TCPIP_CORE_LOCKING)
+    UNLOCK_TCPIP_CORE();
+#endif
+
+    if (err == ERR_OK)
+    {
+        // Cached or literal address
+        server.ip.store(ip4_addr_get_u32(ip_2_ip4(&addr)));
+        sendRequest();
+    }
+    else if (err == ERR_INPROGRESS)
+    {
+        setState(State::RESOLVING);
+    }
+    else
+    {
+        IOTLOGWARN1(F("NTP DNS lookup failed:"), server.host);
+        failAttempt();
+    }
+}
+
+void IoTNtpClient::onDnsResult(const char* name, uint32_t ip)
+{
+    for (uint8_t i = 0; i < _serverCount; ++i)
+    {
+        if (strcmp(_servers[i].host, name) == 0)
+        {
+            _servers[i].ip.store(ip);
+        }
+    }
+}
+
+void IoTNtpClient::sendRequest()
+{
+    // Drop late replies of earlier attempts.
+    while (_udp.parsePacket() > 0)
+    {
+    }
+
+    uint8_t packet[PACKET_SIZE] = {};
+    packet[0] = 0b00100011;     // LI 0, version 4, mode 3 (client)
+
+    // Random transmit timestamp; the server echoes it as originate timestamp.
+    for (uint8_t i = 0; i < sizeof(_nonce); i += 4)
+    {
+        const uint32_t r = static_cast<uint32_t>(random(0x7FFFFFFF)) ^ micros();
+        memcpy(_nonce + i, &r, 4);
+    }
+    memcpy(packet + 40, _nonce, sizeof(_nonce));
+
+    const Server& server = _servers[_current];
+    if (!_udp.beginPacket(IPAddress(server.ip.load()), 123) ||
+        _udp.write(packet, sizeof(packet)) != sizeof(packet) ||
+        !_udp.endPacket())
+    {
+        IOTLOGWARN1(F("NTP send failed:"), server.host);
+        failAttempt();
+        return;
+    }
+    setState(State::WAITING);
+}
+
+bool IoTNtpClient::handleReply()
+{
+    const uint32_t receivedMs = millis();
+    const Server& server = _servers[_current];
+
+    uint8_t packet[PACKET_SIZE];
+    if (_udp.read(packet, sizeof(packet)) != sizeof(packet) ||
+        static_cast<uint32_t>(_udp.remoteIP()) != server.ip.load())
+    {
+        return false;
+    }
+
+    const uint8_t mode    = packet[0] & 0x07;
+    const uint8_t stratum = packet[1];
+    if (mode != 4 || stratum == 0 || stratum > 15 ||
+        memcmp(packet + 24, _nonce, sizeof(_nonce)) != 0)
+    {
+        // Kiss-o'-death, unsynchronised server or a stray packet
+        return false;
+    }
+
+    const uint64_t serverReceiveMs  = ntpToUnixMs(packet + 32);
+    const uint64_t serverTransmitMs = ntpToUnixMs(packet + 40);
+    const uint32_t roundTripMs      = receivedMs - _stateSinceMs;
+    const uint32_t serverHoldMs     = serverTransmitMs > serverReceiveMs
+                                    ? static_cast<uint32_t>(serverTransmitMs - serverReceiveMs) : 0;
+    const uint32_t rttMs            = roundTripMs > serverHoldMs ? roundTripMs - serverHoldMs : 0;
+
+    onSynced(serverTransmitMs + rttMs / 2, receivedMs, rttMs);
+    return true;
+}
+
+void IoTNtpClient::failAttempt()
+{
+    Server& server = _servers[_current];
+    server.failures++;
+    if (++server.failuresInRow >= MAX_FAILURES)
+    {
+        // Pool addresses rotate; look the name up again next time.
+        server.ip.store(0);
+    }
+    startAttempt();
+}
+
+void IoTNtpClient::onSynced(uint64_t utcMs, uint32_t localMs, uint32_t rttMs)
+{
+    Server& server = _servers[_current];
+    server.successes++;
+    server.failuresInRow = 0;
+    server.srttMs = server.srttMs ? (7 * server.srttMs + rttMs) / 8 : (rttMs ? rttMs : 1);
+
+    if (_timeSet)
+    {
+        // Drift of millis() over the interval between two syncs. Short intervals
+        // are dominated by RTT jitter, so they do not update the estimate.
+        const int64_t trueElapsed  = static_cast<int64_t>(utcMs - _syncUtcMs);
+        const int64_t localElapsed = static_cast<uint32_t>(localMs - _syncLocalMs);
+        if (trueElapsed >= 60000)
+        {
+            const int64_t sample = (localElapsed - trueElapsed) * 1000000000LL / trueElapsed;
+            // Ignore steps of the reference (> 1000 ppm)
+            if (sample > -1000000 && sample < 1000000)
+            {
+                _driftPpb += static_cast<int32_t>((sample - _driftPpb) / 4);
+            }
+        }
+    }
+
+    _syncUtcMs    = utcMs;
+    _syncLocalMs  = localMs;
+    _timeSet      = true;
+    _activeServer = _current;
+    _syncCount++;
+    _syncRequested = false;
+    _nextSyncMs   = localMs + _syncIntervalMs;
+    setState(State::IDLE);
+
+    IOTLOGDEBUG2(F("NTP synced, server/RTT:"), server.host, rttMs);
+}
+
+void IoTNtpClient::setState(State state)
+{
+    _state = state;
+    _stateSinceMs = millis();
+}
@@ -0,0 +1,166 @@
+/*
+  IoTNtpClient.h - Non-blocking SNTP client with server selection and drift estimation.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef IOTNTPCLIENT_H
+#define IOTNTPCLIENT_H
+
+#include <Arduino.h>
+#include <WiFiUdp.h>
+#include <atomic>
+
+/**
+ * @brief SNTP client driven by loop() that never waits for the network.
+ *
+ * A sync sends one request and returns; later loop() calls poll for the reply
+ * (or a timeout). Host names are resolved through the asynchronous lwIP
+ * resolver and cached until a server fails repeatedly.
+ *
+ * Up to MAX_SERVERS servers are used. Each successful exchange updates a
+ * smoothed round-trip time of its server, and the server with the lowest RTT
+ * is preferred; every PROBE_EVERY-th sync asks another server so that its RTT
+ * stays current. A server that does not answer is skipped for the rest of the
+ * attempt.
+ *
+ * Successive syncs are used to estimate the drift of the local oscillator,
+ * which utcTimeMs() corrects between syncs.
+ */
+class IoTNtpClient
+{
+public:
+    static constexpr uint8_t  MAX_SERVERS       = 3;
+    static constexpr uint16_t LOCAL_PORT        = 1337;
+    static constexpr uint32_t REPLY_TIMEOUT_MS  = 1000;
+    static constexpr uint32_t DNS_TIMEOUT_MS    = 5000;
+    /** Wait after all servers failed. */
+    static constexpr uint32_t RETRY_MS          = 15000;
+    /** Probe a non-preferred server on every n-th sync. */
+    static constexpr uint8_t  PROBE_EVERY       = 4;
+    /** Re-resolve a server's address after this many failures in a row. */
+    static constexpr uint8_t  MAX_FAILURES      = 3;
+
+    /**
+     * @brief Constructor
+     * @param syncIntervalMs - period of regular syncs
+     */
+    explicit IoTNtpClient(uint32_t syncIntervalMs = 300000UL);
+
+    /**
+     * @brief Add a server. Order is the preference before any RTT is known.
+     * @param host - host name or dotted IP, must stay valid (string literal)
+     * @return false if MAX_SERVERS are already set
+     */
+    bool addServer(const char* host);
+
+    /**
+     * @brief Open the UDP socket and schedule the first sync.
+     */
+    void begin();
+
+    /**
+     * @brief Sync as soon as possible (e.g. after WiFi reconnect).
+     */
+    void requestSync() { _syncRequested = true; }
+
+    /**
+     * @brief Drive the exchange. Never blocks.
+     * @return true if a sync completed during this call.
+     */
+    bool loop();
+
+    /** @brief True while a request is being resolved or awaits its reply. */
+    bool busy() const { return _state != State::IDLE; }
+
+    /** @brief True after the first successful sync. */
+    bool isTimeSet() const { return _timeSet; }
+
+    /** @brief Drift-corrected UTC time in milliseconds since 1970, 0 if not set. */
+    uint64_t utcTimeMs() const;
+
+    /** @brief Drift-corrected UTC time in seconds since 1970, 0 if not set. */
+    time_t utcTime() const { return static_cast<time_t>(utcTimeMs() / 1000); }
+
+    /** @brief Estimated drift of millis() against NTP in ppb (positive = local clock fast). */
+    int32_t driftPpb() const { return _driftPpb; }
+
+    /** @brief Index of the server of the last successful sync, -1 if none. */
+    int8_t activeServer() const { return _activeServer; }
+
+    /**
+     * @brief Per-server statistics and drift as comma separated
+     *        {"name":..,"value":..} objects.
+     */
+    String statusJSON() const;
+
+private:
+    enum class State : uint8_t
+    {
+        IDLE,
+        RESOLVING,
+        WAITING,
+    };
+
+    struct Server
+    {
+        const char* host = nullptr;
+        std::atomic<uint32_t> ip{0};    ///< 0 = unresolved, DNS_FAILED = lookup failed
+        uint32_t srttMs        = 0;     ///< smoothed RTT, 0 = not measured
+        uint16_t successes     = 0;
+        uint16_t failures      = 0;
+        uint8_t  failuresInRow = 0;
+    };
+
+    static constexpr uint32_t DNS_FAILED = 0xFFFFFFFFUL;
+    static constexpr uint32_t UNMEASURED_RTT_MS = 250;
+    static constexpr uint8_t  PACKET_SIZE = 48;
+
+    // Called from the lwIP DNS callback (tcpip task on ESP32).
+    void onDnsResult(const char* name, uint32_t ip);
+
+    bool isDue() const;
+    int8_t selectServer() const;
+    void startAttempt();
+    void startResolve();
+    void sendRequest();
+    bool handleReply();
+    void failAttempt();
+    void onSynced(uint64_t utcMs, uint32_t localMs, uint32_t rttMs);
+    void setState(State state);
+
+    WiFiUDP  _udp;
+    Server   _servers[MAX_SERVERS];
+    uint8_t  _serverCount    = 0;
+    uint32_t _syncIntervalMs;
+
+    State    _state          = State::IDLE;
+    uint32_t _stateSinceMs   = 0;
+    int8_t   _current        = -1;
+    uint8_t  _triedMask      = 0;
+    uint8_t  _nonce[8]       = {};
+    bool     _syncRequested  = false;
+    uint32_t _nextSyncMs     = 0;
+    uint16_t _syncCount      = 0;
+
+    bool     _timeSet        = false;
+    int8_t   _activeServer   = -1;
+    uint64_t _syncUtcMs      = 0;   ///< UTC at _syncLocalMs
+    uint32_t _syncLocalMs    = 0;
+    int32_t  _driftPpb       = 0;
+};
+
+#endif // IOTNTPCLIENT_H
@@ -0,0 +1,73 @@
+/*
+  IoTRtcMemory.cpp - Portable access to RTC memory that survives deep sleep and soft resets.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "IoTRtcMemory.h"
+
+#if defined(ESP32)
+    #include <esp_attr.h>
+
+namespace
+{
+    RTC_NOINIT_ATTR uint32_t s_rtcUserMemory[IoTRtcMemory::BLOCK_COUNT];
+}
+#endif
+
+bool IoTRtcMemory::read(uint32_t block, void* data, size_t size)
+{
+    if (block * 4 + size > BLOCK_COUNT * 4)
+    {
+        return false;
+    }
+#if defined(ESP8266)
+    return ESP.rtcUserMemoryRead(block, static_cast<uint32_t*>(data), size);
+#elif defined(ESP32)
+    memcpy(data, reinterpret_cast<const uint8_t*>(s_rtcUserMemory) + block * 4, size);
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool IoTRtcMemory::write(uint32_t block, const void* data, size_t size)
+{
+    if (block * 4 + size > BLOCK_COUNT * 4)
+    {
+        return false;
+    }
+#if defined(ESP8266)
+    return ESP.rtcUserMemoryWrite(block, static_cast<uint32_t*>(const_cast<void*>(data)), size);
+#elif defined(ESP32)
+    memcpy(reinterpret_cast<uint8_t*>(s_rtcUserMemory) + block * 4, data, size);
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint32_t IoTRtcMemory::checksum(const void* data, size_t size, uint32_t seed)
+{
+    uint32_t hash = seed;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= p[i];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
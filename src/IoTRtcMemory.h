@@ -0,0 +1,77 @@
+/*
+  IoTRtcMemory.h - Portable access to RTC memory that survives deep sleep and soft resets.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef IOTRTCMEMORY_H
+#define IOTRTCMEMORY_H
+
+#include <Arduino.h>
+
+/**
+ * @brief Block-addressed RTC memory shared by the framework.
+ *
+ * On ESP8266 this maps onto ESP.rtcUserMemoryRead/Write(). The first 32 blocks
+ * (128 bytes) of user RTC memory are used by the OTA boot loader, so framework
+ * data starts at block 32. On ESP32 the same layout is emulated by an
+ * RTC_NOINIT_ATTR array, which survives deep sleep and software resets.
+ *
+ * Contents are undefined after power-on; every user must validate its record
+ * (magic + checksum) before trusting it.
+ *
+ * Block map (one block = 4 bytes):
+ *   32..47   IoTWiFiQuickConnect cache
+ *   48..87   IoTDutyCycle record
+ *   88..103  IoTHAPulseCounterWrapper totals (4 blocks per counter)
+ */
+class IoTRtcMemory
+{
+public:
+    /** Number of 4-byte blocks of user RTC memory. */
+    static constexpr uint32_t BLOCK_COUNT = 128;
+
+    /** First block of the WiFi quick-connect cache. */
+    static constexpr uint32_t QUICK_CONNECT_BLOCK  = 32;
+    static constexpr uint32_t QUICK_CONNECT_BLOCKS = 16;
+
+    /** First block of the deep-sleep duty cycle record. */
+    static constexpr uint32_t DUTY_CYCLE_BLOCK  = 48;
+    static constexpr uint32_t DUTY_CYCLE_BLOCKS = 40;
+
+    /** First block of the pulse counter totals. */
+    static constexpr uint32_t PULSE_COUNTER_BLOCK  = 88;
+    static constexpr uint32_t PULSE_COUNTER_BLOCKS = 16;
+
+    /**
+     * @brief Read size bytes starting at block.
+     * @return false if the range does not fit into RTC memory.
+     */
+    static bool read(uint32_t block, void* data, size_t size);
+
+    /**
+     * @brief Write size bytes starting at block.
+     * @return false if the range does not fit into RTC memory.
+     */
+    static bool write(uint32_t block, const void* data, size_t size);
+
+    /**
+     * @brief 32-bit FNV-1a hash used to validate RTC records.
+     */
+    static uint32_t checksum(const void* data, size_t size, uint32_t seed = 2166136261UL);
+};
+
+#endif // IOTRTCMEMORY_H
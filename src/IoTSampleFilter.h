@@ -0,0 +1,319 @@
+/*
+  IoTSampleFilter.h - Compile-time sample filter pipeline for numeric sensors.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "IoTFixedPoint.h"
+
+/**
+ * @brief How a sample type is seen by the filter stages.
+ *
+ * Stages work on Raw: IoTFixedPoint<P> is filtered as its raw int32_t, so a
+ * fixed-point sensor never touches soft-float. Integral and floating point
+ * types are filtered as they are.
+ */
+template<typename T>
+struct IoTFilterTraits
+{
+    static_assert(std::is_arithmetic<T>::value, "IoTFilterTraits: T must be numeric or IoTFixedPoint.");
+
+    using Raw = T;
+
+    static Raw toRaw(const T& value) { return value; }
+    static T fromRaw(Raw raw) { return raw; }
+};
+
+template<uint8_t P>
+struct IoTFilterTraits<IoTFixedPoint<P>>
+{
+    using Raw = int32_t;
+
+    static Raw toRaw(const IoTFixedPoint<P>& value) { return value.raw(); }
+    static IoTFixedPoint<P> fromRaw(Raw raw) { return IoTFixedPoint<P>::fromRaw(raw); }
+};
+
+/**
+ * @brief Running estimate blended towards new samples with a Q16 gain.
+ *
+ * Integral values keep FRAC_BITS extra fraction bits, so small gains still
+ * converge to the input instead of sticking a few units off.
+ */
+template<typename Raw, bool Integral = std::is_integral<Raw>::value>
+class IoTFilterEstimate
+{
+public:
+    static constexpr uint8_t FRAC_BITS = 8;
+
+    void reset(Raw x) { _acc = static_cast<int64_t>(x) * (1 << FRAC_BITS); }
+
+    void blend(Raw x, uint32_t gainQ16)
+    {
+        const int64_t diff = static_cast<int64_t>(x) * (1 << FRAC_BITS) - _acc;
+        _acc += (diff * static_cast<int64_t>(gainQ16) + (diff < 0 ? -0x8000 : 0x8000)) / 0x10000;
+    }
+
+    Raw value() const
+    {
+        const int64_t half = 1 << (FRAC_BITS - 1);
+        return static_cast<Raw>((_acc + (_acc < 0 ? -half : half)) / (1 << FRAC_BITS));
+    }
+
+private:
+    int64_t _acc = 0;
+};
+
+template<typename Raw>
+class IoTFilterEstimate<Raw, false>
+{
+public:
+    void reset(Raw x) { _value = x; }
+    void blend(Raw x, uint32_t gainQ16) { _value += (x - _value) * static_cast<Raw>(gainQ16) / static_cast<Raw>(0x10000); }
+    Raw value() const { return _value; }
+
+private:
+    Raw _value = 0;
+};
+
+/**
+ * @brief Sliding median of the last N samples; removes spikes.
+ *        State: N samples + 2 bytes. Cost: insertion sort of N values.
+ *        Outputs the median of the samples seen so far until N have arrived.
+ */
+template<uint8_t N>
+struct IoTMedian
+{
+    static_assert(N % 2 == 1 && N >= 3 && N <= 15, "IoTMedian: N must be odd, 3..15.");
+
+    template<typename Raw>
+    class Stage
+    {
+    public:
+        bool apply(Raw& value)
+        {
+            _window[_next] = value;
+            _next = static_cast<uint8_t>((_next + 1) % N);
+            if (_count < N)
+            {
+                ++_count;
+            }
+
+            Raw sorted[N];
+            for (uint8_t i = 0; i < _count; ++i)
+            {
+                Raw v = _window[i];
+                uint8_t j = i;
+                for (; j > 0 && sorted[j - 1] > v; --j)
+                {
+                    sorted[j] = sorted[j - 1];
+                }
+                sorted[j] = v;
+            }
+            value = sorted[_count / 2];
+            return true;
+        }
+
+    private:
+        Raw     _window[N] = {};
+        uint8_t _next      = 0;
+        uint8_t _count     = 0;
+    };
+};
+
+/**
+ * @brief Exponential moving average, alpha = Num / Den (C++17 has no float
+ *        template arguments: IoTEma<20> is alpha 0.2).
+ *        State: 8 bytes (4 for float) + 1. Cost: one multiply.
+ */
+template<uint16_t Num, uint16_t Den = 100>
+struct IoTEma
+{
+    static_assert(Num > 0 && Num <= Den, "IoTEma: alpha must be in (0, 1].");
+
+    static constexpr uint32_t GAIN_Q16 = static_cast<uint32_t>((static_cast<uint64_t>(Num) << 16) / Den);
+
+    template<typename Raw>
+    class Stage
+    {
+    public:
+        bool apply(Raw& value)
+        {
+            if (!_started)
+            {
+                _estimate.reset(value);
+                _started = true;
+            }
+            else
+            {
+                _estimate.blend(value, GAIN_Q16);
+            }
+            value = _estimate.value();
+            return true;
+        }
+
+    private:
+        IoTFilterEstimate<Raw> _estimate;
+        bool _started = false;
+    };
+};
+
+/**
+ * @brief One-dimensional Kalman filter for a slowly wandering value.
+ * @tparam ProcessNoise     - variance the true value drifts by per sample [raw units^2]
+ * @tparam MeasurementNoise - variance of a sample [raw units^2]
+ *
+ * The gain is computed in Q16 integers and settles to a constant, after
+ * which the stage costs the same as IoTEma. State: 8 bytes (4 for float) + 8.
+ */
+template<uint32_t ProcessNoise, uint32_t MeasurementNoise>
+struct IoTKalman
+{
+    static_assert(MeasurementNoise > 0, "IoTKalman: MeasurementNoise must be positive.");
+
+    template<typename Raw>
+    class Stage
+    {
+    public:
+        bool apply(Raw& value)
+        {
+            if (_errorVariance == 0)
+            {
+                _estimate.reset(value);
+                _errorVariance = MeasurementNoise;
+            }
+            else
+            {
+                const uint64_t predicted = static_cast<uint64_t>(_errorVariance) + ProcessNoise;
+                const uint32_t gainQ16   = static_cast<uint32_t>((predicted << 16) / (predicted + MeasurementNoise));
+                _estimate.blend(value, gainQ16);
+                const uint64_t updated   = (predicted * (0x10000 - gainQ16)) >> 16;
+                _errorVariance = updated == 0 ? 1 : static_cast<uint32_t>(updated);
+            }
+            value = _estimate.value();
+            return true;
+        }
+
+    private:
+        IoTFilterEstimate<Raw> _estimate;
+        uint32_t _errorVariance = 0;   ///< 0 until the first sample
+    };
+};
+
+/**
+ * @brief Averages N samples into one output; the rest of the chain (and the
+ *        sensor value) only sees every N-th sample.
+ *        State: 8 bytes (sum) + 1. Cost: one add, one divide per output.
+ */
+template<uint8_t N>
+struct IoTOversample
+{
+    static_assert(N >= 2, "IoTOversample: N must be at least 2.");
+
+    template<typename Raw>
+    class Stage
+    {
+        using Sum = typename std::conditional<std::is_integral<Raw>::value, int64_t, Raw>::type;
+
+    public:
+        bool apply(Raw& value)
+        {
+            _sum += value;
+            if (++_count < N)
+            {
+                return false;
+            }
+            if constexpr (std::is_integral<Raw>::value)
+            {
+                value = static_cast<Raw>((_sum + (_sum < 0 ? -(N / 2) : N / 2)) / N);
+            }
+            else
+            {
+                value = _sum / N;
+            }
+            _sum   = 0;
+            _count = 0;
+            return true;
+        }
+
+    private:
+        Sum     _sum   = 0;
+        uint8_t _count = 0;
+    };
+};
+
+/**
+ * @brief Chain of filter stages applied in order, resolved at compile time.
+ *
+ * Each stage keeps fixed-size state in a std::tuple member; a sample runs
+ * through the stages with no virtual calls and no heap. A stage may swallow a
+ * sample (IoTOversample), which ends the chain for that sample.
+ *
+ * @code
+ *   IoTSampleFilter<IoTFixedPoint<1>, IoTMedian<5>, IoTEma<20>> filter;
+ *   IoTFixedPoint<1> out;
+ *   if (filter.push(reading, out)) { ... }
+ * @endcode
+ *
+ * @tparam T      - sample type (numeric or IoTFixedPoint<P>)
+ * @tparam Stages - IoTMedian, IoTEma, IoTKalman, IoTOversample or any type
+ *                  with a nested Stage<Raw> providing bool apply(Raw&)
+ */
+template<typename T, typename... Stages>
+class IoTSampleFilter
+{
+    using Traits = IoTFilterTraits<T>;
+    using Raw    = typename Traits::Raw;
+    using State  = std::tuple<typename Stages::template Stage<Raw>...>;
+
+public:
+    /** RAM taken by the state of all stages. */
+    static constexpr size_t STATE_SIZE = sizeof(State);
+
+    /**
+     * @brief Run a sample through the chain.
+     * @param out - filtered value, written only when true is returned
+     * @return false if a stage swallowed the sample
+     */
+    bool push(const T& sample, T& out)
+    {
+        Raw value = Traits::toRaw(sample);
+        if (!run(value, std::index_sequence_for<Stages...>{}))
+        {
+            return false;
+        }
+        out = Traits::fromRaw(value);
+        return true;
+    }
+
+    /** @brief Forget all history; the next sample starts every stage afresh. */
+    void reset() { _stages = State{}; }
+
+private:
+    template<size_t... I>
+    bool run(Raw& value, std::index_sequence<I...>)
+    {
+        return (true && ... && std::get<I>(_stages).apply(value));
+    }
+
+    State _stages;
+};
@@ -0,0 +1,105 @@
+/*
+  IoTSpscQueue.h - Fixed-size lock-free single-producer/single-consumer queue.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @brief Ring buffer of N items (N a power of two) for exactly one producer
+ *        context and one consumer context.
+ *
+ * The producer only writes _head and the consumer only writes _tail, so plain
+ * atomic loads/stores with acquire/release ordering are enough; no
+ * read-modify-write instructions are needed (the ESP8266 has none). Safe to
+ * use from an SDK callback / async TCP task as producer and loop() as consumer.
+ */
+template<typename T, size_t N>
+class IoTSpscQueue
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "IoTSpscQueue size must be a power of two");
+
+public:
+    /**
+     * @brief Append item (producer side).
+     * @return false if the queue is full
+     */
+    bool push(const T& item)
+    {
+        const uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= N)
+        {
+            return false;
+        }
+        _items[head & (N - 1)] = item;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Append count items at once (producer side). The consumer sees
+     *        either none or all of them.
+     * @return false if there is no room for all items; nothing is queued then
+     */
+    bool push(const T* items, size_t count)
+    {
+        const uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) + count > N)
+        {
+            return false;
+        }
+        for (size_t i = 0; i < count; ++i)
+        {
+            _items[(head + i) & (N - 1)] = items[i];
+        }
+        _head.store(head + count, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Remove the oldest item (consumer side).
+     * @return false if the queue is empty
+     */
+    bool pop(T& item)
+    {
+        const uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (_head.load(std::memory_order_acquire) == tail)
+        {
+            return false;
+        }
+        item = _items[tail & (N - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** @brief True if there is nothing to pop (exact on the consumer side). */
+    bool empty() const
+    {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return N; }
+
+private:
+    T _items[N];
+    std::atomic<uint32_t> _head{0};
+    std::atomic<uint32_t> _tail{0};
+};
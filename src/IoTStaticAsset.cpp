@@ -0,0 +1,66 @@
+/*
+  IoTStaticAsset.cpp - Serving of PROGMEM web assets with ETag and caching.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "IoTStaticAsset.h"
+
+void sendStaticAsset(AsyncWebServerRequest* request, const IoTStaticAsset& asset)
+{
+    const String etag(FPSTR(asset.etag));
+
+    if (request->hasHeader("If-None-Match") && request->header("If-None-Match") == etag)
+    {
+        AsyncWebServerResponse* response = request->beginResponse(304);
+        response->addHeader("ETag", etag);
+        request->send(response);
+        return;
+    }
+
+    AsyncWebServerResponse* response = request->beginResponse_P(
+        200, String(FPSTR(asset.contentType)), asset.data, asset.length);
+    if (asset.gzipped)
+    {
+        response->addHeader("Content-Encoding", "gzip");
+    }
+    response->addHeader("ETag", etag);
+
+    // ETag is "<hash>"; a ?v=<hash> URL is bound to this exact content
+    const bool versioned = request->hasArg("v")
+        && etag.length() == request->arg("v").length() + 2
+        && etag.substring(1, etag.length() - 1) == request->arg("v");
+    response->addHeader("Cache-Control", versioned
+        ? F("public, max-age=31536000, immutable")
+        : F("no-cache"));
+    request->send(response);
+}
+
+IoTStaticAsset makeStaticAsset(PGM_P contentType, PGM_P text, char* etagBuffer)
+{
+    // FNV-1a over the PROGMEM text
+    const size_t length = strlen_P(text);
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < length; ++i)
+    {
+        hash = (hash ^ pgm_read_byte(text + i)) * 16777619UL;
+    }
+    snprintf(etagBuffer, 11, "\"%08lx\"", static_cast<unsigned long>(hash));
+
+    return { contentType, reinterpret_cast<const uint8_t*>(text), length, false, etagBuffer };
+}
@@ -0,0 +1,58 @@
+/*
+  IoTStaticAsset.h - Serving of PROGMEM web assets with ETag and caching.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+class AsyncWebServerRequest;
+
+/**
+ * @brief Static web asset stored in flash.
+ *
+ * Instances are normally generated by tools/gzip_assets.py, which gzips the
+ * source file and derives etag from a hash of its content, e.g.
+ *   IOT_ASSET_HW_STATUS_JS = { "application/javascript", data, len, true, "\"1a2b3c4d\"" }
+ */
+struct IoTStaticAsset
+{
+    PGM_P          contentType;
+    const uint8_t* data;        ///< PROGMEM
+    size_t         length;
+    bool           gzipped;     ///< data is gzip, sent with Content-Encoding: gzip
+    PGM_P          etag;        ///< quoted ETag, PROGMEM or RAM
+};
+
+/**
+ * @brief Answer request with asset.
+ *
+ * Sends "304 Not Modified" when If-None-Match matches the ETag. Otherwise
+ * sends the asset with its ETag. Cache-Control is "immutable" for one year
+ * when the URL carries the content hash (?v=<etag without quotes>), since
+ * such a URL can never refer to other content; without it the browser must
+ * revalidate ("no-cache"), which costs one 304 per load.
+ */
+void sendStaticAsset(AsyncWebServerRequest* request, const IoTStaticAsset& asset);
+
+/**
+ * @brief Build an uncompressed asset from a PROGMEM string, hashing its content
+ *        for the ETag. For assets that are not generated by tools/gzip_assets.py.
+ * @param etagBuffer - storage for the ETag, at least 11 chars; must outlive the asset
+ */
+IoTStaticAsset makeStaticAsset(PGM_P contentType, PGM_P text, char* etagBuffer);
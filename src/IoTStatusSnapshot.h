@@ -0,0 +1,222 @@
+/*
+  IoTStatusSnapshot.h - Double-buffered, lock-free snapshot of component status.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+
+/**
+ * @brief Immutable copy of the status JSON of all components, published by
+ *        loop() at the end of each update cycle and read from any context.
+ *
+ * Two heap buffers, each guarded by its own sequence counter (seqlock). The
+ * writer (loop(), single writer) fills the buffer that is not current, then
+ * makes it current; readers copy the current buffer and retry if its sequence
+ * changed while copying. Readers never block the writer, never see a
+ * half-written cycle and never call into component wrappers.
+ *
+ * The buffers grow to fit the status of all registered components, so nothing
+ * is cut off. A buffer that is replaced while a reader may still copy from it
+ * is freed by a later publish() once no reader is active.
+ */
+class IoTStatusSnapshot
+{
+public:
+    static constexpr uint8_t READ_TRIES = 4;
+
+    IoTStatusSnapshot() = default;
+    IoTStatusSnapshot(const IoTStatusSnapshot&) = delete;
+    IoTStatusSnapshot& operator=(const IoTStatusSnapshot&) = delete;
+
+    ~IoTStatusSnapshot()
+    {
+        for (uint8_t i = 0; i < 2; ++i)
+        {
+            free(_buffers[i].block.load(std::memory_order_relaxed));
+            free(_retired[i]);
+        }
+    }
+
+    /**
+     * @brief Publish len bytes of data as the new snapshot (writer side).
+     * @return false if a larger buffer could not be allocated; the previous
+     *         snapshot stays current in that case
+     */
+    bool publish(const char* data, size_t len)
+    {
+        freeRetired();
+
+        const uint8_t idx = _current.load(std::memory_order_relaxed) ^ 1;
+        Buffer& b = _buffers[idx];
+        // Odd sequence: buffer is being written
+        b.seq.store(b.seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        Block* block = b.block.load(std::memory_order_relaxed);
+        if (!block || block->capacity < len)
+        {
+            block = grow(idx, len);
+            if (!block)
+            {
+                // Back buffer untouched: make it readable again, keep the current one
+                b.seq.store(b.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+                _failed.store(_failed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        memcpy(block->data(), data, len);
+        b.len = len;
+        b.seq.store(b.seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        _current.store(idx, std::memory_order_release);
+        _version.store(_version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Copy the current snapshot into out (any context).
+     * @return false if the writer kept replacing the buffer during READ_TRIES
+     *         attempts or nothing has been published yet; out is empty then
+     */
+    bool read(String& out) const
+    {
+        ReadGuard guard(_readers);
+        for (uint8_t attempt = 0; attempt < READ_TRIES; ++attempt)
+        {
+            const Buffer& b = _buffers[_current.load(std::memory_order_acquire)];
+            const uint32_t seq = b.seq.load(std::memory_order_acquire);
+            const Block* block = b.block.load(std::memory_order_acquire);
+            if (seq == 0 || (seq & 1) || !block)
+            {
+                continue;
+            }
+
+            // len may belong to a newer, larger buffer; the seq check rejects the copy then
+            size_t len = b.len;
+            if (len > block->capacity)
+            {
+                len = block->capacity;
+            }
+            out = String();
+            out.reserve(len);
+            out.concat(block->data(), len);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (b.seq.load(std::memory_order_relaxed) == seq)
+            {
+                return true;
+            }
+        }
+        out = String();
+        return false;
+    }
+
+    /** @brief Number of snapshots published so far (any context). */
+    uint32_t version() const { return _version.load(std::memory_order_acquire); }
+
+    /** @brief Number of snapshots that could not be stored for lack of heap. */
+    uint32_t failed() const { return _failed.load(std::memory_order_relaxed); }
+
+    /** @brief Heap bytes held by both buffers (writer side). */
+    size_t capacity() const
+    {
+        size_t total = 0;
+        for (uint8_t i = 0; i < 2; ++i)
+        {
+            const Block* block = _buffers[i].block.load(std::memory_order_relaxed);
+            total += block ? block->capacity : 0;
+        }
+        return total;
+    }
+
+private:
+    struct Block
+    {
+        size_t capacity;
+        char* data() { return reinterpret_cast<char*>(this + 1); }
+        const char* data() const { return reinterpret_cast<const char*>(this + 1); }
+    };
+
+    struct Buffer
+    {
+        std::atomic<uint32_t> seq{0};   ///< odd while being written
+        std::atomic<Block*>   block{nullptr};
+        size_t len = 0;
+    };
+
+    class ReadGuard
+    {
+    public:
+        explicit ReadGuard(std::atomic<uint8_t>& readers) : _readers(readers) { _readers.fetch_add(1); }
+        ~ReadGuard() { _readers.fetch_sub(1); }
+    private:
+        std::atomic<uint8_t>& _readers;
+    };
+
+    // Replace the block of buffer idx by one that holds at least len bytes
+    Block* grow(uint8_t idx, size_t len)
+    {
+        if (_retired[idx])
+        {
+            return nullptr;   // a reader still holds the previous replacement
+        }
+        // Headroom so that a few more digits do not reallocate every cycle
+        const size_t capacity = len + len / 4 + 16;
+        Block* block = static_cast<Block*>(malloc(sizeof(Block) + capacity));
+        if (!block)
+        {
+            return nullptr;
+        }
+        block->capacity = capacity;
+
+        Block* old = _buffers[idx].block.exchange(block);
+        // A reader that starts after the exchange sees the new block
+        if (_readers.load() == 0)
+        {
+            free(old);
+        }
+        else
+        {
+            _retired[idx] = old;
+        }
+        return block;
+    }
+
+    void freeRetired()
+    {
+        if ((_retired[0] || _retired[1]) && _readers.load() == 0)
+        {
+            free(_retired[0]);
+            free(_retired[1]);
+            _retired[0] = _retired[1] = nullptr;
+        }
+    }
+
+    Buffer _buffers[2];
+    std::atomic<uint8_t>  _current{0};
+    std::atomic<uint32_t> _version{0};
+    std::atomic<uint32_t> _failed{0};
+    mutable std::atomic<uint8_t> _readers{0};
+
+    // Writer side only
+    Block* _retired[2] = {nullptr, nullptr};
+};
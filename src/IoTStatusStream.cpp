@@ -0,0 +1,202 @@
+/*
+  IoTStatusStream.cpp - Server-Sent Events stream of component status deltas.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include <ESPAsyncWebServer.h>
+#include "IoTStatusStream.h"
+#include "IoTDebug.h"
+
+namespace
+{
+    String makeEvent(uint32_t version, const __FlashStringHelper* type, const String& data)
+    {
+        String ev;
+        ev.reserve(data.length() + 40);
+        ev += F("id: ");
+        ev += version;
+        ev += F("\nevent: ");
+        ev += type;
+        ev += F("\ndata: ");
+        ev += data;
+        ev += F("\n\n");
+        return ev;
+    }
+}
+
+void IoTStatusStream::begin(AsyncWebServer& server, const char* path, const IoTStatusSnapshot& snapshot)
+{
+    _snapshot = &snapshot;
+    server.on(path, HTTP_GET, [this](AsyncWebServerRequest* request) {
+        handleRequest(request);
+    });
+}
+
+void IoTStatusStream::publishDelta(uint32_t version, const String& deltaJSON)
+{
+    if (!hasClients() || deltaJSON.isEmpty())
+    {
+        return;
+    }
+
+    const String ev = makeEvent(version, F("delta"), deltaJSON);
+    const uint32_t head = _head.load(std::memory_order_relaxed);
+
+    if (ev.length() > LOG_SIZE)
+    {
+        // Cannot be logged: skip past the whole log so every client resyncs
+        IOTLOGWARN(F("IoTStatusStream: delta larger than IOT_STATUS_STREAM_LOG_SIZE"));
+        _reserved.store(head + LOG_SIZE + 1, std::memory_order_relaxed);
+        _head.store(head + LOG_SIZE + 1, std::memory_order_release);
+        return;
+    }
+
+    const uint32_t end = head + ev.length();
+    _reserved.store(end, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    const char* src = ev.c_str();
+    for (uint32_t pos = head; pos != end; )
+    {
+        const size_t off = pos & (LOG_SIZE - 1);
+        size_t n = LOG_SIZE - off;
+        if (n > end - pos)
+        {
+            n = end - pos;
+        }
+        memcpy(_log + off, src, n);
+        src += n;
+        pos += n;
+    }
+    _head.store(end, std::memory_order_release);
+}
+
+void IoTStatusStream::handleRequest(AsyncWebServerRequest* request)
+{
+    uint8_t slot = 0;
+    while (slot < MAX_CLIENTS && _clients[slot].used)
+    {
+        ++slot;
+    }
+    if (slot == MAX_CLIENTS)
+    {
+        _rejected.store(_rejected.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        request->send(503, "text/plain", "Too many streams");
+        return;
+    }
+
+    Client& client = _clients[slot];
+    client = Client();
+    client.used    = true;
+    client.pending = F("retry: 5000\n\n");
+    _clientCount.store(_clientCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+    request->onDisconnect([this, slot]() {
+        _clients[slot] = Client();
+        _clientCount.store(_clientCount.load(std::memory_order_relaxed) - 1, std::memory_order_release);
+    });
+
+    AsyncWebServerResponse* response = request->beginChunkedResponse("text/event-stream",
+        [this, slot](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            return fill(_clients[slot], buffer, maxLen);
+        });
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+}
+
+size_t IoTStatusStream::fill(Client& client, uint8_t* buffer, size_t maxLen)
+{
+    if (client.pending.isEmpty() && !client.needsFull)
+    {
+        readLog(client);
+    }
+
+    if (client.pending.isEmpty() && client.needsFull)
+    {
+        // Deltas logged after this point are applied on top of the snapshot;
+        // repeating a change the snapshot already contains is harmless.
+        client.cursor = _head.load(std::memory_order_acquire);
+        const uint32_t version = _snapshot->version();
+        String status;
+        if (!_snapshot->read(status))
+        {
+            status = F("[]");
+        }
+        client.pending   = makeEvent(version, F("full"), status);
+        client.needsFull = false;
+    }
+
+    if (client.pending.isEmpty())
+    {
+        if (millis() - client.lastSendMs < KEEPALIVE_MS)
+        {
+            return RESPONSE_TRY_AGAIN;
+        }
+        client.pending = F(":\n\n");
+    }
+
+    size_t len = client.pending.length();
+    if (len > maxLen)
+    {
+        len = maxLen;
+    }
+    memcpy(buffer, client.pending.c_str(), len);
+    client.pending.remove(0, len);
+    client.lastSendMs = millis();
+    return len;
+}
+
+bool IoTStatusStream::readLog(Client& client)
+{
+    const uint32_t head = _head.load(std::memory_order_acquire);
+    if (head == client.cursor)
+    {
+        return false;
+    }
+
+    if (head - client.cursor <= LOG_SIZE)
+    {
+        String events;
+        events.reserve(head - client.cursor);
+        for (uint32_t pos = client.cursor; pos != head; )
+        {
+            const size_t off = pos & (LOG_SIZE - 1);
+            size_t n = LOG_SIZE - off;
+            if (n > head - pos)
+            {
+                n = head - pos;
+            }
+            events.concat(_log + off, n);
+            pos += n;
+        }
+
+        // Valid only if loop() did not start overwriting the copied range
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (_reserved.load(std::memory_order_relaxed) - client.cursor <= LOG_SIZE)
+        {
+            client.pending = events;
+            client.cursor  = head;
+            return true;
+        }
+    }
+
+    // Fell behind by more than the log holds
+    client.needsFull = true;
+    _resyncs.store(_resyncs.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    return false;
+}
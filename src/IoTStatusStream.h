@@ -0,0 +1,113 @@
+/*
+  IoTStatusStream.h - Server-Sent Events stream of component status deltas.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include "IoTStatusSnapshot.h"
+
+class AsyncWebServer;
+class AsyncWebServerRequest;
+
+#ifndef IOT_MAX_STATUS_STREAMS
+    #define IOT_MAX_STATUS_STREAMS 2
+#endif
+
+#ifndef IOT_STATUS_STREAM_LOG_SIZE
+    #define IOT_STATUS_STREAM_LOG_SIZE 2048
+#endif
+
+/**
+ * @brief text/event-stream endpoint pushing status changes to web clients.
+ *
+ * On connect a client gets one "full" event with the current
+ * IoTStatusSnapshot; after that loop() appends a "delta" event (JSON array of
+ * the components whose status changed) to a shared byte log at the end of
+ * each update cycle. Every client has its own read cursor into the log and is
+ * served by a chunked response, so:
+ *
+ *  - loop() never touches TCP; it only writes the log (single writer),
+ *  - a client is only fed when its TCP window has room; a client that falls
+ *    more than LOG_SIZE bytes behind is resynchronised with a new "full"
+ *    event instead of buffering without bound (per-client backpressure),
+ *  - at most MAX_CLIENTS streams are open; further requests get 503.
+ *
+ * Event ids are snapshot versions. Idle streams get a comment line every
+ * KEEPALIVE_MS so proxies and the browser keep them open.
+ */
+class IoTStatusStream
+{
+public:
+    static constexpr uint8_t  MAX_CLIENTS  = IOT_MAX_STATUS_STREAMS;
+    static constexpr size_t   LOG_SIZE     = IOT_STATUS_STREAM_LOG_SIZE;
+    static constexpr uint32_t KEEPALIVE_MS = 15000;
+
+    /**
+     * @brief Register the stream route.
+     * @param snapshot - source of "full" events, read lock-free
+     */
+    void begin(AsyncWebServer& server, const char* path, const IoTStatusSnapshot& snapshot);
+
+    /** @brief True while at least one client is connected (any context). */
+    bool hasClients() const { return _clientCount.load(std::memory_order_acquire) != 0; }
+
+    /**
+     * @brief Append a delta event for all connected clients (loop() context).
+     * @param version   - snapshot version the delta leads to
+     * @param deltaJSON - JSON array of changed component status objects
+     */
+    void publishDelta(uint32_t version, const String& deltaJSON);
+
+    /** @brief Number of full resyncs caused by slow clients. */
+    uint32_t resyncs() const { return _resyncs.load(std::memory_order_relaxed); }
+
+    /** @brief Number of connections refused because MAX_CLIENTS streams were open. */
+    uint32_t rejected() const { return _rejected.load(std::memory_order_relaxed); }
+
+private:
+    struct Client
+    {
+        bool     used      = false;
+        bool     needsFull = true;
+        uint32_t cursor    = 0;     ///< position in the log of the next event
+        uint32_t lastSendMs = 0;
+        String   pending;           ///< bytes produced but not yet sent
+    };
+
+    // Async web server context
+    void handleRequest(AsyncWebServerRequest* request);
+    size_t fill(Client& client, uint8_t* buffer, size_t maxLen);
+    bool readLog(Client& client);
+
+    static_assert((LOG_SIZE & (LOG_SIZE - 1)) == 0, "IOT_STATUS_STREAM_LOG_SIZE must be a power of two");
+
+    const IoTStatusSnapshot* _snapshot = nullptr;
+    Client _clients[MAX_CLIENTS];
+    std::atomic<uint8_t> _clientCount{0};
+
+    // Log written by loop(): bytes [_head - LOG_SIZE, _head) are readable,
+    // _reserved is the end of the event being written.
+    char _log[LOG_SIZE];
+    std::atomic<uint32_t> _head{0};
+    std::atomic<uint32_t> _reserved{0};
+
+    std::atomic<uint32_t> _resyncs{0};
+    std::atomic<uint32_t> _rejected{0};
+};
@@ -33,6 +33,10 @@
  *   OTA_END       : flag = true if success, false if error
  *   WIFI_CONNECTED: arg1 = IP address as uint32_t (host byte order)
  *   RESTARTING    : no extra fields — fired just before ESP.restart()/reset()
+ *   SENSOR_FAULT  : flag = true when a component's update() starts failing,
+ *                   false when it recovers; arg1 = component index,
+ *                   source = the IoTHADeviceWrapperBase
+ *   SETTINGS_CHANGED : source = settings namespace name (const char*, e.g. "APP")
  */
 struct IoTSystemEvent
 {
@@ -46,10 +50,22 @@ struct IoTSystemEvent
         MQTT_CONNECTED,
         MQTT_DISCONNECTED,
         RESTARTING,
+        SENSOR_FAULT,
+        SETTINGS_CHANGED,
     };
 
-    Type     type;
-    uint32_t arg1 = 0;
-    uint32_t arg2 = 0;
-    bool     flag  = false;
+    /** Number of event types, for per-type tables. */
+    static constexpr uint8_t TYPE_COUNT = static_cast<uint8_t>(Type::SETTINGS_CHANGED) + 1;
+
+    /** Bit of type in a subscription mask. */
+    static constexpr uint32_t maskOf(Type type) { return 1UL << static_cast<uint8_t>(type); }
+
+    /** Subscription mask for every event type. */
+    static constexpr uint32_t ALL_TYPES = (1UL << TYPE_COUNT) - 1;
+
+    Type        type;
+    uint32_t    arg1   = 0;
+    uint32_t    arg2   = 0;
+    bool        flag   = false;
+    const void* source = nullptr;
 };
@@ -0,0 +1,85 @@
+/*
+  IoTSystemEventBus.cpp - Publish/subscribe delivery of system events.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <Arduino.h>
+#include "IoTSystemEventBus.h"
+#include "IoTDebug.h"
+
+bool IoTSystemEventBus::subscribe(IoTSystemEventListener& listener, uint32_t typeMask)
+{
+    typeMask &= IoTSystemEvent::ALL_TYPES;
+    if (typeMask == 0)
+    {
+        return false;
+    }
+
+    uint8_t i = 0;
+    while (i < _listenerCount && _listeners[i] != &listener)
+    {
+        ++i;
+    }
+    if (i == _listenerCount)
+    {
+        if (_listenerCount >= MAX_SUBSCRIBERS)
+        {
+            IOTLOGWARN(F("IoTSystemEventBus: MAX_SUBSCRIBERS reached, listener not subscribed"));
+            return false;
+        }
+        _listeners[_listenerCount++] = &listener;
+    }
+    _masks[i] = typeMask;
+    rebuild();
+    return true;
+}
+
+void IoTSystemEventBus::unsubscribe(IoTSystemEventListener& listener)
+{
+    for (uint8_t i = 0; i < _listenerCount; ++i)
+    {
+        if (_listeners[i] == &listener)
+        {
+            for (uint8_t j = i + 1; j < _listenerCount; ++j)
+            {
+                _listeners[j - 1] = _listeners[j];
+                _masks[j - 1]     = _masks[j];
+            }
+            --_listenerCount;
+            rebuild();
+            return;
+        }
+    }
+}
+
+void IoTSystemEventBus::rebuild()
+{
+    uint8_t n = 0;
+    for (uint8_t type = 0; type < IoTSystemEvent::TYPE_COUNT; ++type)
+    {
+        _start[type] = n;
+        const uint32_t bit = 1UL << type;
+        for (uint8_t i = 0; i < _listenerCount; ++i)
+        {
+            if (_masks[i] & bit)
+            {
+                _entries[n++] = i;
+            }
+        }
+    }
+    _start[IoTSystemEvent::TYPE_COUNT] = n;
+}
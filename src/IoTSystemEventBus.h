@@ -0,0 +1,109 @@
+/*
+  IoTSystemEventBus.h - Publish/subscribe delivery of system events.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include "IoTSystemEvent.h"
+
+#ifndef IOT_MAX_EVENT_SUBSCRIBERS
+    #define IOT_MAX_EVENT_SUBSCRIBERS 16
+#endif
+
+/**
+ * @brief Receiver of system events.
+ *
+ * Implemented by IoTTextDisplay, IoTDisplayPage and IoTHADeviceWrapperBase.
+ * IoTDevice subscribes displays, pages and components on registration with
+ * the mask returned by systemEventMask().
+ */
+class IoTSystemEventListener
+{
+public:
+    virtual ~IoTSystemEventListener() = default;
+
+    /**
+     * @brief Called in loop() context for every subscribed event type.
+     */
+    virtual void onSystemEvent(const IoTSystemEvent& event) {}
+
+    /**
+     * @brief Event types to subscribe to on registration, a combination of
+     *        IoTSystemEvent::maskOf(). Default: none.
+     */
+    virtual uint32_t systemEventMask() const { return 0; }
+};
+
+/**
+ * @brief Delivers each event only to the listeners subscribed to its type.
+ *
+ * Subscriptions are compiled into one table of per-type subscriber lists
+ * (offsets + indices), so publishing costs one call per interested listener.
+ * The table is rebuilt on subscribe()/unsubscribe(), which is meant for
+ * setup time; do not change subscriptions from inside onSystemEvent().
+ */
+class IoTSystemEventBus
+{
+public:
+    static constexpr uint8_t MAX_SUBSCRIBERS = IOT_MAX_EVENT_SUBSCRIBERS;
+
+    /**
+     * @brief Subscribe listener to the event types in typeMask. Subscribing an
+     *        already subscribed listener replaces its mask.
+     * @return false if typeMask is 0 or MAX_SUBSCRIBERS is reached
+     */
+    bool subscribe(IoTSystemEventListener& listener, uint32_t typeMask);
+
+    /**
+     * @brief Remove listener from all event types.
+     */
+    void unsubscribe(IoTSystemEventListener& listener);
+
+    /**
+     * @brief Deliver event to its subscribers, in subscription order.
+     */
+    void publish(const IoTSystemEvent& event) const
+    {
+        const uint8_t type = static_cast<uint8_t>(event.type);
+        for (uint8_t i = _start[type]; i < _start[type + 1]; ++i)
+        {
+            _listeners[_entries[i]]->onSystemEvent(event);
+        }
+    }
+
+    /** @brief Number of listeners subscribed to type. */
+    uint8_t subscriberCount(IoTSystemEvent::Type type) const
+    {
+        const uint8_t t = static_cast<uint8_t>(type);
+        return _start[t + 1] - _start[t];
+    }
+
+private:
+    void rebuild();
+
+    static_assert(MAX_SUBSCRIBERS * IoTSystemEvent::TYPE_COUNT <= 255,
+                  "IoTSystemEventBus indices must fit into uint8_t");
+
+    IoTSystemEventListener* _listeners[MAX_SUBSCRIBERS] = {};
+    uint32_t _masks[MAX_SUBSCRIBERS] = {};
+    uint8_t  _listenerCount = 0;
+
+    // Subscribers of type t are _listeners[_entries[_start[t] .. _start[t+1]-1]]
+    uint8_t  _start[IoTSystemEvent::TYPE_COUNT + 1] = {};
+    uint8_t  _entries[MAX_SUBSCRIBERS * IoTSystemEvent::TYPE_COUNT] = {};
+};
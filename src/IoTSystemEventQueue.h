@@ -0,0 +1,118 @@
+/*
+  IoTSystemEventQueue.h - Hand-off of system events from SDK/async callbacks to loop().
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include "IoTSpscQueue.h"
+#include "IoTSystemEvent.h"
+
+#ifndef IOT_SYSTEM_EVENT_QUEUE_SIZE
+    #define IOT_SYSTEM_EVENT_QUEUE_SIZE 16
+#endif
+
+/**
+ * @brief Lock-free queue of IoTSystemEvent records.
+ *
+ * Callbacks (WiFi SDK events, OTA callbacks from the async web server) push();
+ * IoTApplication::loop() calls drain(). There must be a single producer
+ * context: on ESP8266 all these callbacks run in the SYS context, on ESP32 in
+ * the async TCP task.
+ *
+ * OTA_PROGRESS is coalesced: while one progress event is still queued, newer
+ * progress only updates its arguments, so a fast upload cannot fill the queue
+ * and the consumer always sees the latest byte count. Ordering relative to
+ * OTA_START/OTA_END is kept.
+ */
+class IoTSystemEventQueue
+{
+public:
+    /**
+     * @brief Queue an event (producer side). Never blocks.
+     * @return false if the event was dropped because the queue is full
+     */
+    bool push(const IoTSystemEvent& event)
+    {
+        if (event.type == IoTSystemEvent::Type::OTA_PROGRESS)
+        {
+            _progressArg1.store(event.arg1);
+            _progressArg2.store(event.arg2);
+            // seq_cst: either the queued marker is still pending and the consumer
+            // will read the arguments stored above, or a new marker is queued.
+            if (_progressPending.load())
+            {
+                _coalesced.store(_coalesced.load(std::memory_order_relaxed) + 1,
+                                 std::memory_order_relaxed);
+                return true;
+            }
+            _progressPending.store(true);
+        }
+
+        if (!_queue.push(event))
+        {
+            if (event.type == IoTSystemEvent::Type::OTA_PROGRESS)
+            {
+                _progressPending.store(false);
+            }
+            _overflows.store(_overflows.load(std::memory_order_relaxed) + 1,
+                             std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Deliver all queued events to handler (consumer side).
+     * @param handler - callable taking const IoTSystemEvent&
+     */
+    template<typename Handler>
+    void drain(Handler&& handler)
+    {
+        IoTSystemEvent event;
+        while (_queue.pop(event))
+        {
+            if (event.type == IoTSystemEvent::Type::OTA_PROGRESS)
+            {
+                _progressPending.store(false);
+                event.arg1 = _progressArg1.load();
+                event.arg2 = _progressArg2.load();
+            }
+            handler(event);
+        }
+    }
+
+    /** @brief True if no event is queued (consumer side). */
+    bool empty() const { return _queue.empty(); }
+
+    /** @brief Number of events dropped because the queue was full. */
+    uint32_t overflows() const { return _overflows.load(std::memory_order_relaxed); }
+
+    /** @brief Number of OTA_PROGRESS events merged into an already queued one. */
+    uint32_t coalesced() const { return _coalesced.load(std::memory_order_relaxed); }
+
+private:
+    IoTSpscQueue<IoTSystemEvent, IOT_SYSTEM_EVENT_QUEUE_SIZE> _queue;
+
+    std::atomic<bool>     _progressPending{false};
+    std::atomic<uint32_t> _progressArg1{0};
+    std::atomic<uint32_t> _progressArg2{0};
+
+    // Written by the producer only
+    std::atomic<uint32_t> _overflows{0};
+    std::atomic<uint32_t> _coalesced{0};
+};
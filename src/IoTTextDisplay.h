@@ -20,7 +20,8 @@
 #pragma once
 
 #include <Arduino.h>
-#include "IoTSystemEvent.h"
+#include "IoTSystemEventBus.h"
+#include "IoTFixedPoint.h"
 
 /**
  * @brief Abstract interface for a character (row × col) text display.
@@ -29,7 +30,7 @@
  * Optional capabilities (backlight, custom characters) are provided as
  * virtual no-ops so subclasses without those features still compile.
  */
-class IoTTextDisplay
+class IoTTextDisplay : public IoTSystemEventListener
 {
 public:
     virtual ~IoTTextDisplay() = default;
@@ -84,6 +85,17 @@ public:
      */
     void print(const String& text) { print(text.c_str()); }
 
+    /**
+     * @brief Print a fixed-point value using integer-only formatting.
+     */
+    template<uint8_t P>
+    void print(const IoTFixedPoint<P>& value)
+    {
+        char buf[IoTFixedPoint<P>::MAX_CHARS];
+        value.toChars(buf, sizeof(buf));
+        print(buf);
+    }
+
     /**
      * @brief Write text starting at column 0 of the given row, padding the
      *        remainder of the row with spaces so old content is erased without
@@ -99,6 +111,18 @@ public:
             print(" ");
     }
 
+    /**
+     * @brief printLine() for a flash string, e.g. FPSTR(deviceProperties().versionString).
+     */
+    void printLine(uint8_t row, const __FlashStringHelper* text)
+    {
+        setCursor(0, row);
+        print(text);
+        const size_t len = strlen_P(reinterpret_cast<PGM_P>(text));
+        for (size_t i = len; i < cols(); ++i)
+            print(" ");
+    }
+
     // --- Optional capabilities — default no-ops ---
 
     /**
@@ -121,7 +145,12 @@ public:
      * @brief Called when a system event occurs (OTA, restart, etc.).
      *        Default no-op; concrete displays override to show status text.
      */
-    virtual void onSystemEvent(const IoTSystemEvent& event) {}
+    void onSystemEvent(const IoTSystemEvent& event) override {}
+
+    /**
+     * @brief Event types delivered to onSystemEvent(). Default: all.
+     */
+    uint32_t systemEventMask() const override { return IoTSystemEvent::ALL_TYPES; }
 
 #ifdef _IOT_REAL_TIME
     /**
@@ -0,0 +1,94 @@
+/*
+  IoTTimezoneCache.cpp - UTC to local time conversion with cached DST transitions.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "IoTTimezoneCache.h"
+#include <limits>
+
+void IoTTimezoneCache::update(time_t utc)
+{
+    if (_dstStart.offset == _stdStart.offset)
+    {
+        // No DST, one offset forever
+        _offset     = _stdStart.offset * 60;
+        _validFrom  = std::numeric_limits<time_t>::min();
+        _validUntil = std::numeric_limits<time_t>::max();
+        return;
+    }
+
+    // Transitions of the neighbouring years bracket any instant of this year,
+    // also for rules where DST spans the new year (southern hemisphere).
+    _validFrom  = std::numeric_limits<time_t>::min();
+    _validUntil = std::numeric_limits<time_t>::max();
+    const int y = year(utc);
+    for (int yr = y - 1; yr <= y + 1; ++yr)
+    {
+        // Same as Timezone: each transition happens at the local time of the
+        // offset in effect before it.
+        const time_t transitions[2] = {
+            ruleToLocal(_dstStart, yr) - _stdStart.offset * 60,
+            ruleToLocal(_stdStart, yr) - _dstStart.offset * 60,
+        };
+        const int offsetsAfter[2] = { _dstStart.offset, _stdStart.offset };
+
+        for (uint8_t i = 0; i < 2; ++i)
+        {
+            if (transitions[i] <= utc && transitions[i] >= _validFrom)
+            {
+                _validFrom = transitions[i];
+                _offset = offsetsAfter[i] * 60;
+            }
+            else if (transitions[i] > utc && transitions[i] < _validUntil)
+            {
+                _validUntil = transitions[i];
+            }
+        }
+    }
+}
+
+time_t IoTTimezoneCache::ruleToLocal(const TimeChangeRule& rule, int year)
+{
+    // Mirrors Timezone::toTime_t(); week 0 means the last week of the month.
+    uint8_t month = rule.month;
+    uint8_t week  = rule.week;
+    if (week == 0)
+    {
+        if (++month > 12)
+        {
+            month = 1;
+            ++year;
+        }
+        week = 1;
+    }
+
+    tmElements_t tm;
+    tm.Hour   = rule.hour;
+    tm.Minute = 0;
+    tm.Second = 0;
+    tm.Day    = 1;
+    tm.Month  = month;
+    tm.Year   = CalendarYrToTm(year);
+    time_t t = makeTime(tm);
+
+    t += ((rule.dow - weekday(t) + 7) % 7 + (week - 1) * 7) * SECS_PER_DAY;
+    if (rule.week == 0)
+    {
+        t -= 7 * SECS_PER_DAY;
+    }
+    return t;
+}
@@ -0,0 +1,84 @@
+/*
+  IoTTimezoneCache.h - UTC to local time conversion with cached DST transitions.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef IOTTIMEZONECACHE_H
+#define IOTTIMEZONECACHE_H
+
+#include <Timezone.h>
+
+/**
+ * @brief Same conversion as Timezone::toLocal(), but the offset is cached
+ *        together with the UTC interval [validFrom, validUntil) between the
+ *        previous and the next DST transition.
+ *
+ * Inside that interval toLocal() is one comparison and one addition; the rules
+ * are evaluated again only after a transition has passed (or for a time
+ * outside the interval).
+ */
+class IoTTimezoneCache
+{
+public:
+    /**
+     * @brief Constructor
+     * @param dstStart - rule for start of dst or summer time
+     * @param stdStart - rule for start of standard time
+     */
+    IoTTimezoneCache(const TimeChangeRule& dstStart, const TimeChangeRule& stdStart) :
+        _dstStart(dstStart),
+        _stdStart(stdStart)
+    {
+    }
+
+    /**
+     * @brief Convert UTC to local time.
+     */
+    time_t toLocal(time_t utc)
+    {
+        if (utc < _validFrom || utc >= _validUntil)
+        {
+            update(utc);
+        }
+        return utc + _offset;
+    }
+
+    /** @brief UTC of the next transition after the last conversion. */
+    time_t nextTransition() const { return _validUntil; }
+
+    /** @brief UTC of the transition in effect for the last conversion. */
+    time_t previousTransition() const { return _validFrom; }
+
+private:
+    /**
+     * @brief Recompute the offset and its validity interval around utc.
+     */
+    void update(time_t utc);
+
+    /**
+     * @brief Local time of the transition described by rule in year.
+     */
+    static time_t ruleToLocal(const TimeChangeRule& rule, int year);
+
+    TimeChangeRule _dstStart;
+    TimeChangeRule _stdStart;
+    time_t  _validFrom  = 0;
+    time_t  _validUntil = 0;   // empty interval forces the first update()
+    int32_t _offset     = 0;   // seconds
+};
+
+#endif // IOTTIMEZONECACHE_H
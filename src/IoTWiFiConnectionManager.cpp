@@ -0,0 +1,370 @@
+/*
+  IoTWiFiConnectionManager.cpp - Non-blocking selection, failover and roaming between
+  the access points configured in the WIFI and WIFI2 settings.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "IoTWiFiConnectionManager.h"
+#include "IoTApplication.h"
+#include "WifiSettings.h"
+#include "JSONUtils.h"
+#include "IoTDebug.h"
+
+bool IoTWiFiConnectionManager::begin()
+{
+    static const char* const namespaces[MAX_APS] = { "WIFI", "WIFI2" };
+
+    _apCount = 0;
+    for (uint8_t i = 0; i < MAX_APS; ++i)
+    {
+        WiFiSettings settings(namespaces[i]);
+        settings.read();
+        if (!settings.SSID().isEmpty())
+        {
+            _aps[_apCount].ssid     = settings.SSID().c_str();
+            _aps[_apCount].password = settings.password().c_str();
+            _apCount++;
+        }
+    }
+
+    if (_apCount == 0)
+    {
+        setState(State::IDLE);
+        return false;
+    }
+
+    // An AP from the RTC cache connects without any scan.
+    for (uint8_t i = 0; i < _apCount; ++i)
+    {
+        if (IoTWiFiQuickConnect::hasCache(_aps[i].ssid))
+        {
+            connectTo(i);
+            return true;
+        }
+    }
+
+    selectAccessPoint(true);
+    return true;
+}
+
+bool IoTWiFiConnectionManager::loop()
+{
+    const bool connected = _quickConnect.loop();
+    const uint32_t now = millis();
+
+    switch (_state)
+    {
+        case State::IDLE:
+            break;
+
+        case State::SCANNING:
+        {
+            const int16_t n = WiFi.scanComplete();
+            if (n != WIFI_SCAN_RUNNING)
+            {
+                // On failure fall back to the configured order.
+                rankAccessPoints(n);
+                WiFi.scanDelete();
+                connectNext();
+            }
+            break;
+        }
+
+        case State::CONNECTING:
+            if (connected)
+            {
+                onConnected();
+            }
+            else if (now - _attemptBeginMs >= CONNECT_TIMEOUT_MS)
+            {
+                onAttemptFailed();
+            }
+            break;
+
+        case State::CONNECTED:
+            if (!connected)
+            {
+                IOTLOGWARN1(F("WiFi link lost: "), _aps[_current].ssid);
+                setState(State::DISCONNECTED);
+            }
+            else
+            {
+                checkQuality();
+            }
+            break;
+
+        case State::ROAM_SCANNING:
+        {
+            const int16_t n = WiFi.scanComplete();
+            if (n != WIFI_SCAN_RUNNING)
+            {
+                rankAccessPoints(n);
+                WiFi.scanDelete();
+                evaluateRoaming();
+            }
+            break;
+        }
+
+        case State::DISCONNECTED:
+            if (connected)
+            {
+                // SDK auto-reconnect to the same AP
+                setState(State::CONNECTED);
+            }
+            else if (now - _stateSinceMs >= FAILOVER_DISCONNECT_MS)
+            {
+                IOTLOGWARN(F("WiFi link down too long, failing over"));
+                WiFi.disconnect();
+                selectAccessPoint(true);
+            }
+            break;
+
+        case State::BACKOFF:
+            if (now - _stateSinceMs >= RETRY_BACKOFF_MS)
+            {
+                selectAccessPoint(true);
+            }
+            break;
+    }
+
+    return connected;
+}
+
+String IoTWiFiConnectionManager::statusJSON() const
+{
+    String s;
+    for (uint8_t i = 0; i < _apCount; ++i)
+    {
+        const ApStats& st = _aps[i].stats;
+        String value;
+        value += st.successes;
+        value += '/';
+        value += st.attempts;
+        value += F(" ok, last ");
+        value += st.lastConnectMs;
+        value += F(" ms, avg ");
+        value += st.avgConnectMs;
+        value += F(" ms");
+        if (i == _current && _state == State::CONNECTED)
+        {
+            value += F(" (active)");
+        }
+
+        if (i > 0) s += ',';
+        String obj;
+        obj += JSONUtils::Pair(F("name"),  _aps[i].ssid, true);
+        obj += JSONUtils::Pair(F("value"), value);
+        s += JSONUtils::EncloseObject(obj);
+    }
+    return s;
+}
+
+void IoTWiFiConnectionManager::setState(State state)
+{
+    _state = state;
+    _stateSinceMs = millis();
+}
+
+void IoTWiFiConnectionManager::selectAccessPoint(bool newRound)
+{
+    if (newRound)
+    {
+        for (uint8_t i = 0; i < _apCount; ++i)
+        {
+            _aps[i].failed = false;
+        }
+    }
+    _orderCount = 0;
+
+    if (_apCount == 1)
+    {
+        // Nothing to rank, let WiFi.begin() do its own scan.
+        rankAccessPoints(WIFI_SCAN_FAILED);
+        connectNext();
+    }
+    else
+    {
+        startScan();
+        setState(State::SCANNING);
+    }
+}
+
+void IoTWiFiConnectionManager::startScan()
+{
+    WiFi.scanDelete();
+    WiFi.scanNetworks(true);
+}
+
+void IoTWiFiConnectionManager::rankAccessPoints(int16_t scanCount)
+{
+    for (uint8_t i = 0; i < _apCount; ++i)
+    {
+        _aps[i].seen = false;
+    }
+
+    // Strongest BSSID per configured SSID
+    for (int16_t n = 0; n < scanCount; ++n)
+    {
+        const String ssid = WiFi.SSID(n);
+        const int32_t rssi = WiFi.RSSI(n);
+        for (uint8_t i = 0; i < _apCount; ++i)
+        {
+            AccessPoint& ap = _aps[i];
+            if (ap.ssid == ssid && (!ap.seen || rssi > ap.rssi))
+            {
+                ap.seen    = true;
+                ap.rssi    = rssi;
+                ap.channel = WiFi.channel(n);
+                memcpy(ap.bssid, WiFi.BSSID(n), sizeof(ap.bssid));
+            }
+        }
+    }
+
+    // Seen APs by RSSI, then the rest (e.g. hidden SSIDs) in configured order
+    _orderCount = 0;
+    for (uint8_t i = 0; i < _apCount; ++i)
+    {
+        uint8_t pos = _orderCount;
+        if (_aps[i].seen)
+        {
+            while (pos > 0 && (!_aps[_order[pos - 1]].seen || _aps[_order[pos - 1]].rssi < _aps[i].rssi))
+            {
+                _order[pos] = _order[pos - 1];
+                --pos;
+            }
+        }
+        _order[pos] = i;
+        _orderCount++;
+    }
+}
+
+void IoTWiFiConnectionManager::connectNext()
+{
+    for (uint8_t pos = 0; pos < _orderCount; ++pos)
+    {
+        if (!_aps[_order[pos]].failed)
+        {
+            connectTo(_order[pos]);
+            return;
+        }
+    }
+
+    IOTLOGWARN(F("No configured WiFi AP reachable, retrying later"));
+    setState(State::BACKOFF);
+}
+
+void IoTWiFiConnectionManager::connectTo(uint8_t ap)
+{
+    AccessPoint& target = _aps[ap];
+    _current = ap;
+    target.stats.attempts++;
+    _attemptBeginMs = millis();
+    _lowQualitySinceMs = 0;
+
+    IOTLOGINFO2(F("WiFi connecting to:"), target.ssid, target.seen ? target.rssi : 0);
+    if (target.seen)
+    {
+        _quickConnect.begin(target.ssid, target.password, target.channel, target.bssid);
+    }
+    else
+    {
+        _quickConnect.begin(target.ssid, target.password);
+    }
+    setState(State::CONNECTING);
+}
+
+void IoTWiFiConnectionManager::onAttemptFailed()
+{
+    IOTLOGWARN1(F("WiFi connect failed: "), _aps[_current].ssid);
+    _aps[_current].failed = true;
+    WiFi.disconnect();
+
+    if (_orderCount == 0)
+    {
+        // The attempt came from the RTC cache, rank the others now.
+        selectAccessPoint(false);
+    }
+    else
+    {
+        connectNext();
+    }
+}
+
+void IoTWiFiConnectionManager::onConnected()
+{
+    ApStats& st = _aps[_current].stats;
+    st.lastConnectMs = millis() - _attemptBeginMs;
+    st.successes++;
+    st.avgConnectMs += static_cast<int32_t>(st.lastConnectMs - st.avgConnectMs) / st.successes;
+
+    IOTLOGINFO2(F("WiFi connected to:"), _aps[_current].ssid, st.lastConnectMs);
+    setState(State::CONNECTED);
+}
+
+void IoTWiFiConnectionManager::checkQuality()
+{
+    const uint32_t now = millis();
+    if (_apCount < 2 || now - _qualityCheckMs < 1000)
+    {
+        return;
+    }
+    _qualityCheckMs = now;
+
+    if (IoTApplication::getRSSIasQuality(WiFi.RSSI()) >= LOW_QUALITY)
+    {
+        _lowQualitySinceMs = 0;
+        return;
+    }
+
+    if (_lowQualitySinceMs == 0)
+    {
+        _lowQualitySinceMs = now;
+    }
+    else if (now - _lowQualitySinceMs >= LOW_QUALITY_MS &&
+             (!_roamScanDone || now - _roamScanMs >= ROAM_SCAN_INTERVAL_MS))
+    {
+        _roamScanMs = now;
+        _roamScanDone = true;
+        startScan();
+        setState(State::ROAM_SCANNING);
+    }
+}
+
+void IoTWiFiConnectionManager::evaluateRoaming()
+{
+    const uint8_t currentQuality = IoTApplication::getRSSIasQuality(WiFi.RSSI());
+    const uint8_t* currentBssid = WiFi.BSSID();
+
+    const AccessPoint& best = _aps[_order[0]];
+    const bool sameBssid = currentBssid && memcmp(best.bssid, currentBssid, sizeof(best.bssid)) == 0;
+    if (WiFi.status() == WL_CONNECTED && best.seen && !sameBssid &&
+        IoTApplication::getRSSIasQuality(best.rssi) >= currentQuality + ROAM_MARGIN)
+    {
+        IOTLOGINFO2(F("WiFi roaming to:"), best.ssid, best.rssi);
+        for (uint8_t i = 0; i < _apCount; ++i)
+        {
+            _aps[i].failed = false;
+        }
+        WiFi.disconnect();
+        connectTo(_order[0]);
+        return;
+    }
+
+    // Stay; the regular checks take over again (also if the link dropped meanwhile).
+    _lowQualitySinceMs = 0;
+    setState(State::CONNECTED);
+}
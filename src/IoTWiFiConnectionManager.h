@@ -0,0 +1,156 @@
+/*
+  IoTWiFiConnectionManager.h - Non-blocking selection, failover and roaming between
+  the access points configured in the WIFI and WIFI2 settings.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef IOTWIFICONNECTIONMANAGER_H
+#define IOTWIFICONNECTIONMANAGER_H
+
+#include "IoTWiFiQuickConnect.h"
+
+/**
+ * @brief Connects to the best of the configured access points and keeps the
+ *        station connected.
+ *
+ * begin() reads the "WIFI" and "WIFI2" settings. If the RTC quick-connect cache
+ * matches one of them, that AP is tried first without scanning. Otherwise an
+ * asynchronous scan ranks the configured APs by RSSI and the strongest one is
+ * joined by BSSID/channel. A failed attempt moves on to the next ranked AP.
+ *
+ * While connected the manager fails over after the link has been down for
+ * FAILOVER_DISCONNECT_MS, and roams (scan + switch) when the signal quality
+ * stays below LOW_QUALITY for LOW_QUALITY_MS and another configured AP is
+ * at least ROAM_MARGIN better.
+ *
+ * All work happens in loop(), which never blocks.
+ */
+class IoTWiFiConnectionManager
+{
+public:
+    /** Number of settings namespaces ("WIFI", "WIFI2"). */
+    static constexpr uint8_t MAX_APS = 2;
+
+    /** Give up on an AP if not connected within this time. */
+    static constexpr uint32_t CONNECT_TIMEOUT_MS      = 10000;
+    /** Link down this long (SDK reconnect included) triggers a failover. */
+    static constexpr uint32_t FAILOVER_DISCONNECT_MS  = 15000;
+    /** Wait between rounds once every AP failed. */
+    static constexpr uint32_t RETRY_BACKOFF_MS        = 30000;
+    /** Quality (0-100, see IoTApplication::getRSSIasQuality) considered poor. */
+    static constexpr uint8_t  LOW_QUALITY             = 30;
+    /** Poor quality this long triggers a roaming scan. */
+    static constexpr uint32_t LOW_QUALITY_MS          = 60000;
+    /** Minimum time between two roaming scans. */
+    static constexpr uint32_t ROAM_SCAN_INTERVAL_MS   = 300000;
+    /** Required quality advantage of the new AP before roaming. */
+    static constexpr uint8_t  ROAM_MARGIN             = 15;
+
+    /**
+     * @brief Per-AP connection statistics.
+     */
+    struct ApStats
+    {
+        uint16_t attempts      = 0;
+        uint16_t successes     = 0;
+        uint32_t lastConnectMs = 0;   ///< latency of the last successful attempt
+        uint32_t avgConnectMs  = 0;   ///< mean latency of successful attempts
+    };
+
+    /**
+     * @brief Read the configured APs and start connecting.
+     * @return false if no AP is configured.
+     */
+    bool begin();
+
+    /**
+     * @brief Drive scanning, connecting, failover and roaming.
+     * @return true while the station is connected.
+     */
+    bool loop();
+
+    /** @brief Number of configured APs. */
+    uint8_t apCount() const { return _apCount; }
+
+    /** @brief SSID of configured AP i. */
+    const String& ssid(uint8_t i) const { return _aps[i].ssid; }
+
+    /** @brief Statistics of configured AP i. */
+    const ApStats& stats(uint8_t i) const { return _aps[i].stats; }
+
+    /** @brief Index of the AP of the current/last attempt, -1 if none. */
+    int8_t currentAp() const { return _current; }
+
+    /** @brief The underlying connect attempt (path and per-path durations). */
+    const IoTWiFiQuickConnect& quickConnect() const { return _quickConnect; }
+
+    /**
+     * @brief Per-AP statistics as comma separated {"name":..,"value":..} objects.
+     */
+    String statusJSON() const;
+
+private:
+    enum class State : uint8_t
+    {
+        IDLE,           ///< nothing configured
+        SCANNING,       ///< scan for (re)selection
+        CONNECTING,     ///< attempt on _current in progress
+        CONNECTED,
+        ROAM_SCANNING,  ///< connected, scanning for a better AP
+        DISCONNECTED,   ///< link lost, SDK reconnecting
+        BACKOFF,        ///< every AP failed, waiting for the next round
+    };
+
+    struct AccessPoint
+    {
+        String   ssid;
+        String   password;
+        int32_t  rssi     = 0;
+        int32_t  channel  = 0;
+        uint8_t  bssid[6] = {};
+        bool     seen     = false;    ///< found by the last scan
+        bool     failed   = false;    ///< failed in the current round
+        ApStats  stats;
+    };
+
+    void setState(State state);
+    void selectAccessPoint(bool newRound);
+    void startScan();
+    void rankAccessPoints(int16_t scanCount);
+    void connectNext();
+    void connectTo(uint8_t ap);
+    void onAttemptFailed();
+    void onConnected();
+    void checkQuality();
+    void evaluateRoaming();
+
+    AccessPoint _aps[MAX_APS];
+    uint8_t  _apCount          = 0;
+    uint8_t  _order[MAX_APS]   = {};   ///< AP indices, best first
+    uint8_t  _orderCount       = 0;    ///< 0 = not ranked in this round yet
+    int8_t   _current          = -1;
+    State    _state            = State::IDLE;
+    uint32_t _stateSinceMs     = 0;
+    uint32_t _attemptBeginMs   = 0;
+    uint32_t _lowQualitySinceMs = 0;
+    uint32_t _qualityCheckMs   = 0;
+    uint32_t _roamScanMs       = 0;
+    bool     _roamScanDone     = false;
+    IoTWiFiQuickConnect _quickConnect;
+};
+
+#endif // IOTWIFICONNECTIONMANAGER_H
@@ -0,0 +1,238 @@
+/*
+  IoTWiFiQuickConnect.cpp - WiFi station connect that reuses the last BSSID, channel and
+  DHCP lease cached in RTC memory.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "IoTWiFiQuickConnect.h"
+#include "IoTRtcMemory.h"
+#include "IoTDebug.h"
+
+void IoTWiFiQuickConnect::begin(const String& ssid, const String& password,
+                                int32_t channel, const uint8_t* bssid)
+{
+    _ssid      = ssid;
+    _password  = password;
+    _connected = false;
+    _channel   = bssid ? channel : 0;
+    if (bssid)
+    {
+        memcpy(_bssid, bssid, sizeof(_bssid));
+    }
+
+    Cache cache;
+    const bool cached = loadCache(cache) && cache.ssidHash == ssidHash(ssid) &&
+        (!bssid || memcmp(cache.bssid, bssid, sizeof(cache.bssid)) == 0);
+    if (cached && cache.leaseAgeS >= IOT_WIFI_LEASE_MAX_AGE_S)
+    {
+        IOTLOGINFO1(F("WiFi cached lease too old, using DHCP, age [s]: "), cache.leaseAgeS);
+    }
+    if (cached && cache.leaseAgeS < IOT_WIFI_LEASE_MAX_AGE_S)
+    {
+        _path = Path::QUICK;
+        _attemptStartMs = millis();
+        WiFi.config(IPAddress(cache.ip), IPAddress(cache.gateway),
+                    IPAddress(cache.subnet), IPAddress(cache.dns));
+        _staticConfig = true;
+        _leaseBaseS   = cache.leaseAgeS;
+        _leaseStartMs = millis();
+        WiFi.begin(ssid.c_str(), password.c_str(), cache.channel, cache.bssid);
+        IOTLOGINFO1(F("WiFi quick connect, channel: "), cache.channel);
+    }
+    else
+    {
+        beginFull();
+    }
+}
+
+bool IoTWiFiQuickConnect::loop()
+{
+    if (_path == Path::NONE)
+    {
+        return false;
+    }
+
+    if (WiFi.status() == WL_CONNECTED)
+    {
+        if (!_connected)
+        {
+            _connected = true;
+            onConnected();
+        }
+        else if (millis() - _leaseSavedMs >= LEASE_SAVE_MS)
+        {
+            if (_staticConfig && leaseAgeS() >= IOT_WIFI_LEASE_MAX_AGE_S)
+            {
+                // Get a fresh lease without reconnecting; saved on the next pass
+                IOTLOGINFO(F("WiFi cached lease too old, renewing via DHCP"));
+                WiFi.config(IPAddress(0u), IPAddress(0u), IPAddress(0u));
+                _staticConfig = false;
+                _leaseBaseS   = 0;
+                _leaseStartMs = millis();
+                _leaseSavedMs = _leaseStartMs;
+            }
+            else
+            {
+                saveLease();
+            }
+        }
+        return true;
+    }
+    _connected = false;
+
+    if (_path == Path::QUICK && _attemptStartMs != 0 &&
+        millis() - _attemptStartMs >= QUICK_TIMEOUT_MS)
+    {
+        IOTLOGWARN(F("WiFi quick connect failed, falling back to full scan"));
+        invalidate();
+        WiFi.disconnect();
+        beginFull();
+    }
+    return false;
+}
+
+void IoTWiFiQuickConnect::invalidate()
+{
+    Cache cache = {};
+    IoTRtcMemory::write(IoTRtcMemory::QUICK_CONNECT_BLOCK, &cache, sizeof(cache));
+}
+
+void IoTWiFiQuickConnect::ageCache(uint32_t ms)
+{
+    Cache cache;
+    if (loadCache(cache))
+    {
+        cache.leaseAgeS += ms / 1000;
+        storeCache(cache);
+    }
+}
+
+bool IoTWiFiQuickConnect::hasCache(const String& ssid)
+{
+    Cache cache;
+    return loadCache(cache) && cache.ssidHash == ssidHash(ssid);
+}
+
+const __FlashStringHelper* IoTWiFiQuickConnect::pathName(Path path)
+{
+    switch (path)
+    {
+        case Path::QUICK: return F("quick");
+        case Path::FULL:  return F("full");
+        default:          return F("none");
+    }
+}
+
+void IoTWiFiQuickConnect::beginFull()
+{
+    _path = Path::FULL;
+    _attemptStartMs = millis();
+    _leaseBaseS     = 0;   // DHCP gets a fresh lease
+    if (_staticConfig)
+    {
+        // The cached lease belongs to the previous network (or timed out).
+        // Zero addresses re-enable DHCP on both ESP8266 and ESP32.
+        WiFi.config(IPAddress(0u), IPAddress(0u), IPAddress(0u));
+        _staticConfig = false;
+    }
+    if (_channel != 0)
+    {
+        WiFi.begin(_ssid.c_str(), _password.c_str(), _channel, _bssid);
+    }
+    else
+    {
+        WiFi.begin(_ssid.c_str(), _password.c_str());
+    }
+}
+
+void IoTWiFiQuickConnect::onConnected()
+{
+    const uint32_t duration = millis() - _attemptStartMs;
+    if (_attemptStartMs != 0)
+    {
+        if (_path == Path::QUICK)
+            _quickDurationMs = duration;
+        else
+            _fullDurationMs = duration;
+        IOTLOGINFO2(F("WiFi connected via path:"), pathName(_path), duration);
+    }
+    // Later reconnects are driven by the SDK; do not time them against this attempt.
+    _attemptStartMs = 0;
+
+    // A reconnect with the cached static config keeps the lease it had;
+    // only DHCP hands out a fresh one.
+    _leaseBaseS   = _staticConfig ? leaseAgeS() : 0;
+    _leaseStartMs = millis();
+    saveLease();
+
+    // Credentials are only needed for the fallback of this attempt.
+    _password = String();
+}
+
+void IoTWiFiQuickConnect::saveLease()
+{
+    Cache cache = {};
+    cache.ssidHash = ssidHash(_ssid);
+    cache.ip       = static_cast<uint32_t>(WiFi.localIP());
+    cache.gateway  = static_cast<uint32_t>(WiFi.gatewayIP());
+    cache.subnet   = static_cast<uint32_t>(WiFi.subnetMask());
+    cache.dns      = static_cast<uint32_t>(WiFi.dnsIP());
+    cache.leaseAgeS = leaseAgeS();
+    cache.channel  = static_cast<uint8_t>(WiFi.channel());
+    const uint8_t* bssid = WiFi.BSSID();
+    if (bssid)
+    {
+        memcpy(cache.bssid, bssid, sizeof(cache.bssid));
+    }
+    storeCache(cache);
+    _leaseSavedMs = millis();
+}
+
+bool IoTWiFiQuickConnect::loadCache(Cache& cache)
+{
+    if (!IoTRtcMemory::read(IoTRtcMemory::QUICK_CONNECT_BLOCK, &cache, sizeof(cache)))
+    {
+        return false;
+    }
+    return cache.magic == CACHE_MAGIC &&
+           cache.checksum == cacheChecksum(cache) &&
+           cache.ip != 0 && cache.channel != 0;
+}
+
+void IoTWiFiQuickConnect::storeCache(Cache& cache)
+{
+    static_assert(sizeof(Cache) % 4 == 0,
+        "IoTWiFiQuickConnect::Cache must be a multiple of 4 bytes");
+    static_assert(sizeof(Cache) <= IoTRtcMemory::QUICK_CONNECT_BLOCKS * 4,
+        "IoTWiFiQuickConnect::Cache does not fit into its RTC memory blocks");
+
+    cache.magic    = CACHE_MAGIC;
+    cache.checksum = cacheChecksum(cache);
+    IoTRtcMemory::write(IoTRtcMemory::QUICK_CONNECT_BLOCK, &cache, sizeof(cache));
+}
+
+uint32_t IoTWiFiQuickConnect::cacheChecksum(const Cache& cache)
+{
+    // Everything after the magic and checksum fields.
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(&cache) + 2 * sizeof(uint32_t);
+    return IoTRtcMemory::checksum(p, sizeof(Cache) - 2 * sizeof(uint32_t));
+}
+
+uint32_t IoTWiFiQuickConnect::ssidHash(const String& ssid)
+{
+    return IoTRtcMemory::checksum(ssid.c_str(), ssid.length());
+}
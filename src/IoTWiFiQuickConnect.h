@@ -0,0 +1,161 @@
+/*
+  IoTWiFiQuickConnect.h - WiFi station connect that reuses the last BSSID, channel and
+  DHCP lease cached in RTC memory.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#ifndef IOTWIFIQUICKCONNECT_H
+#define IOTWIFIQUICKCONNECT_H
+
+#if defined(ESP8266)
+    #include <ESP8266WiFi.h>
+#elif defined(ESP32)
+    #include <WiFi.h>
+#endif
+
+#ifndef IOT_WIFI_LEASE_MAX_AGE_S
+    #define IOT_WIFI_LEASE_MAX_AGE_S (6UL * 60 * 60)   // half of a 12 h lease
+#endif
+
+/**
+ * @brief Non-blocking WiFi station connect with an RTC-cached fast path.
+ *
+ * A plain WiFi.begin(ssid, pwd) scans all channels and runs DHCP on every boot.
+ * After each successful connection this class stores the BSSID, channel and the
+ * DHCP lease (IP, gateway, subnet, DNS) in RTC memory. On the next boot begin()
+ * tries a directed connect to that BSSID/channel with the cached address
+ * configured statically. If that does not succeed within QUICK_TIMEOUT_MS the
+ * cache is dropped and a normal scan + DHCP connect is started.
+ *
+ * The cached lease is never renewed while it is applied statically, so its age
+ * is kept in the cache: time connected (saved every LEASE_SAVE_MS) plus deep
+ * sleep time reported through ageCache(). Once it reaches
+ * IOT_WIFI_LEASE_MAX_AGE_S the next begin() uses DHCP, and a running station
+ * switches to DHCP in place.
+ *
+ * Call loop() regularly; it never blocks.
+ */
+class IoTWiFiQuickConnect
+{
+public:
+    /**
+     * @brief How the current/last connection attempt was made.
+     */
+    enum class Path : uint8_t
+    {
+        NONE,   ///< begin() not called yet
+        QUICK,  ///< directed connect with cached BSSID/channel/IP
+        FULL,   ///< full channel scan + DHCP
+    };
+
+    /** Give the quick path this long before falling back to a full scan. */
+    static constexpr uint32_t QUICK_TIMEOUT_MS = 3000;
+
+    /** Interval of the lease age update in the cache while connected. */
+    static constexpr uint32_t LEASE_SAVE_MS = 60000;
+
+    /**
+     * @brief Start connecting to ssid. Uses the quick path when a valid cache
+     *        for the same SSID (and BSSID, if given) exists.
+     * @param channel, bssid  Optional target from a scan; the full path then
+     *        connects directly to this access point instead of scanning again.
+     */
+    void begin(const String& ssid, const String& password,
+               int32_t channel = 0, const uint8_t* bssid = nullptr);
+
+    /**
+     * @brief Drive fallback and cache update.
+     * @return true while the station is connected.
+     */
+    bool loop();
+
+    /**
+     * @brief Forget the cached BSSID/channel/lease (e.g. after changing WiFi settings).
+     */
+    static void invalidate();
+
+    /**
+     * @brief Add time the station spends outside loop(), e.g. deep sleep, to
+     *        the age of the cached lease. Call right before sleeping.
+     */
+    static void ageCache(uint32_t ms);
+
+    /** @brief True if a valid cache entry for ssid exists. */
+    static bool hasCache(const String& ssid);
+
+    /** @brief Path used by the current attempt. */
+    Path path() const { return _path; }
+
+    /** @brief millis() when the current attempt (quick or full) was started. */
+    uint32_t attemptStartMs() const { return _attemptStartMs; }
+
+    /** @brief Duration of the last successful connect via the given path, 0 if none. */
+    uint32_t connectDurationMs(Path path) const
+    {
+        return path == Path::QUICK ? _quickDurationMs : (path == Path::FULL ? _fullDurationMs : 0);
+    }
+
+    /** @brief Human readable path name for logs and status pages. */
+    static const __FlashStringHelper* pathName(Path path);
+
+private:
+    /**
+     * @brief Record stored in RTC memory, must be a multiple of 4 bytes.
+     */
+    struct Cache
+    {
+        uint32_t magic;
+        uint32_t checksum;
+        uint32_t ssidHash;
+        uint32_t ip;
+        uint32_t gateway;
+        uint32_t subnet;
+        uint32_t dns;
+        uint32_t leaseAgeS;   ///< since the lease was obtained via DHCP
+        uint8_t  bssid[6];
+        uint8_t  channel;
+        uint8_t  reserved;
+    };
+
+    static constexpr uint32_t CACHE_MAGIC = 0x51434E32UL;   // "QCN2"
+
+    static bool loadCache(Cache& cache);
+    static void storeCache(Cache& cache);
+    static uint32_t cacheChecksum(const Cache& cache);
+    static uint32_t ssidHash(const String& ssid);
+
+    void beginFull();
+    void onConnected();
+    void saveLease();
+    uint32_t leaseAgeS() const { return _leaseBaseS + (millis() - _leaseStartMs) / 1000; }
+
+    String   _ssid;
+    String   _password;
+    int32_t  _channel         = 0;
+    uint8_t  _bssid[6]        = {};
+    Path     _path            = Path::NONE;
+    uint32_t _attemptStartMs  = 0;
+    uint32_t _quickDurationMs = 0;
+    uint32_t _fullDurationMs  = 0;
+    bool     _connected       = false;
+    bool     _staticConfig    = false;   ///< cached lease applied with WiFi.config()
+    uint32_t _leaseBaseS      = 0;       ///< lease age at _leaseStartMs
+    uint32_t _leaseStartMs    = 0;
+    uint32_t _leaseSavedMs    = 0;
+};
+
+#endif // IOTWIFIQUICKCONNECT_H
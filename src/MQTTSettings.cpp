@@ -33,18 +33,18 @@ MQTTSettings::MQTTSettings(PGM_P psName) :
 
 void MQTTSettings::readFields(Preferences& pref)
 {
-    m_mqttServer = pref.getString(PREF_MQTT_SETTING_SERVER, "");
+    readValue(pref, PREF_MQTT_SETTING_SERVER, m_mqttServer);
     m_mqttPort = pref.getUShort(PREF_MQTT_SETTING_PORT, 1883);
-    m_mqttUser = pref.getString(PREF_MQTT_SETTING_USER, "");
-    m_mqttPassword = pref.getString(PREF_MQTT_SETTING_PASSWORD, "");
+    readValue(pref, PREF_MQTT_SETTING_USER, m_mqttUser);
+    readValue(pref, PREF_MQTT_SETTING_PASSWORD, m_mqttPassword);
 }
 
 bool MQTTSettings::saveFields(Preferences& pref) const
 {
-    pref.putString(PREF_MQTT_SETTING_SERVER, m_mqttServer);
+    pref.putString(PREF_MQTT_SETTING_SERVER, m_mqttServer.c_str());
     pref.putUShort(PREF_MQTT_SETTING_PORT, m_mqttPort);
-    pref.putString(PREF_MQTT_SETTING_USER, m_mqttUser);
-    pref.putString(PREF_MQTT_SETTING_PASSWORD, m_mqttPassword);
+    pref.putString(PREF_MQTT_SETTING_USER, m_mqttUser.c_str());
+    pref.putString(PREF_MQTT_SETTING_PASSWORD, m_mqttPassword.c_str());
 
     return true;
 }
@@ -30,6 +30,14 @@
 class MQTTSettings : public Settings
 {
 public:
+    static constexpr size_t SERVER_LEN   = 64;
+    static constexpr size_t USER_LEN     = 32;
+    static constexpr size_t PASSWORD_LEN = 64;
+
+    using ServerString   = IoTFixedString<SERVER_LEN>;
+    using UserString     = IoTFixedString<USER_LEN>;
+    using PasswordString = IoTFixedString<PASSWORD_LEN>;
+
     /**
      * @brief Constructor
      * @param psName - Namespace name
@@ -40,7 +48,7 @@ public:
      * @brief Return MQTT server name
      * @return MQTT server name
      */
-    const String& MQTTServer() const 
+    const ServerString& MQTTServer() const
     {
         return m_mqttServer;
     }
@@ -49,7 +57,7 @@ public:
      * @brief Set MQTT server name
      * @param name - MQTT server name
      */
-    void setMQTTServer(const String& name)
+    void setMQTTServer(const char* name)
     {
         updateValue(name, m_mqttServer, true);
     }
@@ -76,7 +84,7 @@ public:
      * @brief Return MQTT user name
      * @return MQTT user name
      */
-    const String& MQTTUser() const 
+    const UserString& MQTTUser() const
     {
         return m_mqttUser;
     }
@@ -85,7 +93,7 @@ public:
      * @brief Set MQTT user name
      * @param name - MQTT user name
      */
-    void setMQTTUser(const String& name)
+    void setMQTTUser(const char* name)
     {
         updateValue(name, m_mqttUser, true);
     }
@@ -94,7 +102,7 @@ public:
      * @brief Return MQTT password
      * @return MQTT password
      */
-    const String& MQTTPassword() const 
+    const PasswordString& MQTTPassword() const
     {
         return m_mqttPassword;
     }
@@ -103,7 +111,7 @@ public:
      * @brief Set MQTT password
      * @param password - MQTT password
      */
-    void setMQTTPassword(const String& password)
+    void setMQTTPassword(const char* password)
     {
         updateValue(password, m_mqttPassword, true);
     }
@@ -113,10 +121,10 @@ protected:
     bool saveFields(Preferences& pref) const override;
 
 private:
-    String m_mqttServer;
-    uint16_t m_mqttPort = 1883;
-    String m_mqttUser;
-    String m_mqttPassword;
+    ServerString   m_mqttServer;
+    uint16_t       m_mqttPort = 1883;
+    UserString     m_mqttUser;
+    PasswordString m_mqttPassword;
 };
 
 #endif // MQTTSETTINGS_H
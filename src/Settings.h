@@ -23,6 +23,9 @@
 #define SETTINGS_H
 
 #include <Preferences.h>
+#include <ctype.h>
+#include "IoTFixedString.h"
+#include "IoTDebug.h"
 
 /**
  * Base abstract classes to manage settings persistently stored
@@ -64,6 +67,11 @@ public:
         return _isDirty;
     }
 
+    /**
+     * @brief Return namespace
+    */
+    PGM_P name() const;
+
 protected:
     /**
      * @brief Update setting's member
@@ -79,20 +87,60 @@ protected:
     }
 
     /**
-     * @brief Update setting's member
+     * @brief Update setting's string member.
+     *        Trimming skips the surrounding white space without a copy.
+     * @return false if the value is longer than the capacity; the member
+     *         keeps its previous value then, a cut credential would be wrong
      */
-    void updateValue(String value, String& member, bool bTrim)
+    template <size_t N>
+    bool updateValue(const char* value, IoTFixedString<N>& member, bool bTrim = false)
     {
+        if (!value)
+        {
+            value = "";
+        }
+        size_t len = strlen(value);
         if (bTrim)
         {
-            value.trim();
+            while (len > 0 && isspace(static_cast<unsigned char>(*value)))
+            {
+                ++value;
+                --len;
+            }
+            while (len > 0 && isspace(static_cast<unsigned char>(value[len - 1])))
+            {
+                --len;
+            }
+        }
+        if (len > N)
+        {
+            IOTLOGERROR3(FPSTR(_name), F("setting too long, not changed, length / capacity:"), len, N);
+            return false;
         }
 
-        if (member != value)
+        if (!member.equals(value, len))
         {
-            member = value;
+            member.assign(value, len);
             _isDirty = true;
         }
+        return true;
+    }
+
+    /**
+     * @brief Read a string into member's buffer. A missing key, or a value
+     *        longer than the capacity, reads as empty; the latter is logged.
+     */
+    template <size_t N>
+    static void readValue(Preferences& pref, const char* key, IoTFixedString<N>& member)
+    {
+        if (pref.getString(key, member.buffer(), N + 1) == 0)
+        {
+            if (pref.isKey(key))
+            {
+                IOTLOGERROR2(F("Stored setting longer than"), N, key);
+            }
+            member.assign("");
+        }
     }
 
 protected:
@@ -106,11 +154,6 @@ protected:
     */
     virtual bool saveFields(Preferences& pref) const = 0;
 
-    /**
-     * @brief Return namespace
-    */
-    PGM_P name() const;
-
 protected:
     PGM_P _name;
     mutable bool _isDirty = false;
@@ -34,25 +34,22 @@ WiFiSettings::WiFiSettings(PGM_P psName) :
 
 void WiFiSettings::readFields(Preferences& pref)
 {
-    m_ssid = pref.getString(PREF_WIFI_SETTING_SSID, "");
-    m_password = pref.getString(PREF_WIFI_SETTING_PASSWORD, "");
-    String m_staticIP;
-    String m_staticGateway;
-    String m_staticSubnet;
-
-    m_staticIP = pref.getString(PREF_WIFI_SETTING_STATIC_IP, "");
-    m_staticGateway = pref.getString(PREF_WIFI_SETTING_STATIC_GATEWAY, "");
-    m_staticSubnet = pref.getString(PREF_WIFI_SETTING_STATIC_SUBNET, "");
+    readValue(pref, PREF_WIFI_SETTING_SSID, m_ssid);
+    readValue(pref, PREF_WIFI_SETTING_PASSWORD, m_password);
+
+    readValue(pref, PREF_WIFI_SETTING_STATIC_IP, m_staticIP);
+    readValue(pref, PREF_WIFI_SETTING_STATIC_GATEWAY, m_staticGateway);
+    readValue(pref, PREF_WIFI_SETTING_STATIC_SUBNET, m_staticSubnet);
 }
 
 bool WiFiSettings::saveFields(Preferences& pref) const
 {
-    pref.putString(PREF_WIFI_SETTING_SSID, m_ssid);
-    pref.putString(PREF_WIFI_SETTING_PASSWORD, m_password);
+    pref.putString(PREF_WIFI_SETTING_SSID, m_ssid.c_str());
+    pref.putString(PREF_WIFI_SETTING_PASSWORD, m_password.c_str());
 
-    pref.putString(PREF_WIFI_SETTING_STATIC_IP, m_staticIP);
-    pref.putString(PREF_WIFI_SETTING_STATIC_GATEWAY, m_staticGateway);
-    pref.putString(PREF_WIFI_SETTING_STATIC_SUBNET, m_staticSubnet);
+    pref.putString(PREF_WIFI_SETTING_STATIC_IP, m_staticIP.c_str());
+    pref.putString(PREF_WIFI_SETTING_STATIC_GATEWAY, m_staticGateway.c_str());
+    pref.putString(PREF_WIFI_SETTING_STATIC_SUBNET, m_staticSubnet.c_str());
  
     return true;
 }
@@ -30,6 +30,14 @@
 class WiFiSettings : public Settings
 {
 public:
+    static constexpr size_t SSID_LEN     = 32;   ///< 802.11 limit
+    static constexpr size_t PASSWORD_LEN = 64;   ///< WPA2 passphrase or hex PSK
+    static constexpr size_t ADDRESS_LEN  = 15;   ///< "255.255.255.255"
+
+    using SSIDString     = IoTFixedString<SSID_LEN>;
+    using PasswordString = IoTFixedString<PASSWORD_LEN>;
+    using AddressString  = IoTFixedString<ADDRESS_LEN>;
+
     /**
      * @brief Constructor
      * @param psName - Namespace name
@@ -40,7 +48,7 @@ public:
      * @brief Return SSID (name of WIFI network)
      * @return SSID name
      */
-    const String& SSID() const 
+    const SSIDString& SSID() const
     {
         return m_ssid;
     }
@@ -49,7 +57,7 @@ public:
      * @brief Set SSID name
      * @param ssid - SSID name
      */
-    void setSSID(const String& ssid)
+    void setSSID(const char* ssid)
     {
         updateValue(ssid, m_ssid);
     }
@@ -58,7 +66,7 @@ public:
      * @brief Return SSID password
      * @return SSID password
      */
-    const String& password() const 
+    const PasswordString& password() const
     {
         return m_password;
     }
@@ -67,7 +75,7 @@ public:
      * @brief Set SSID password
      * @param ssid - SSID password
      */
-    void setPassword(const String& password)
+    void setPassword(const char* password)
     {
         updateValue(password, m_password);
     }
@@ -76,7 +84,7 @@ public:
      * @brief Return static IP address
      * @return static IP address
      */
-    const String& staticIP() const 
+    const AddressString& staticIP() const
     {
         return m_staticIP;
     }
@@ -85,7 +93,7 @@ public:
      * @brief Set static IP address
      * @param address static IP address
      */
-    void setStaticIP(const String& address)
+    void setStaticIP(const char* address)
     {
         updateValue(address, m_staticIP, true);
     }
@@ -94,7 +102,7 @@ public:
      * @brief Return static gateway address
      * @return static gateway address
      */
-    const String& staticGateway() const 
+    const AddressString& staticGateway() const
     {
         return m_staticGateway;
     }
@@ -103,7 +111,7 @@ public:
      * @brief Set static gateway address
      * @param address static gateway address
      */
-    void setStaticGateway(const String& address)
+    void setStaticGateway(const char* address)
     {
         updateValue(address, m_staticGateway, true);
     }
@@ -112,7 +120,7 @@ public:
      * @brief Return static subnet mask
      * @return static subnet mask
      */
-    const String& staticSubnet() const 
+    const AddressString& staticSubnet() const
     {
         return m_staticSubnet;
     }
@@ -121,7 +129,7 @@ public:
      * @brief Set MQTT user name
      * @param addressMask - MQTT user name
      */
-    void setStaticSubnet(const String& addressMask)
+    void setStaticSubnet(const char* addressMask)
     {
         updateValue(addressMask, m_staticSubnet, true);
     }
@@ -131,11 +139,11 @@ public:
     bool saveFields(Preferences& pref) const override;
 
 private:
-    String m_ssid;
-    String m_password;
-    String m_staticIP;
-    String m_staticGateway;
-    String m_staticSubnet;
+    SSIDString     m_ssid;
+    PasswordString m_password;
+    AddressString  m_staticIP;
+    AddressString  m_staticGateway;
+    AddressString  m_staticSubnet;
  };
 
 #endif // WIFISETTINGS_H
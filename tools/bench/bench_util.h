@@ -0,0 +1,48 @@
+/*
+  bench_util.h - Timing helpers for the host benchmarks in tools/bench.
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+/** Keeps results alive so the optimiser cannot drop the measured work. */
+inline volatile int64_t g_benchSink = 0;
+
+/**
+ * @brief Run body(i) for i in [0, iterations) and return ns per iteration.
+ *        One untimed warm-up pass fills caches and branch predictors.
+ */
+template<typename Body>
+double benchNsPerOp(uint32_t iterations, Body&& body)
+{
+    for (uint32_t i = 0; i < iterations / 10; ++i)
+    {
+        body(i);
+    }
+    const auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i)
+    {
+        body(i);
+    }
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(ns) / iterations;
+}
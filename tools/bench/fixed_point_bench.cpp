@@ -0,0 +1,107 @@
+/*
+  fixed_point_bench.cpp - Host benchmark of IoTFixedPoint against float on the
+  format and publish paths of a numeric sensor.
+
+  Build and run from the repository root:
+    g++ -std=c++17 -O2 -Wall -Wextra -Isrc tools/bench/fixed_point_bench.cpp -o fixed_point_bench
+    ./fixed_point_bench
+
+  Rows:
+    format   - value to text for statusJSON() and the display:
+               IoTFixedPoint::toChars() vs snprintf("%.1f")
+    publish  - value to the scaled integer HANumeric carries to MQTT:
+               raw() vs float * 10^P rounded, as HANumeric(float, P) does
+    combined - both of the above for one reading
+
+  The host has an FPU, so the gap is much smaller here than on the ESP8266,
+  where every float operation is a soft-float library call.
+
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include <cmath>
+#include "IoTFixedPoint.h"
+#include "bench_util.h"
+
+namespace
+{
+    using Fixed = IoTFixedPoint<1>;
+
+    constexpr uint32_t ITERATIONS = 2000000;
+    constexpr uint32_t SAMPLE_COUNT = 1024;   // power of two
+
+    Fixed g_fixed[SAMPLE_COUNT];
+    float g_float[SAMPLE_COUNT];
+
+    // Temperatures from -40.0 to +85.0 in 0.1 steps
+    void makeSamples()
+    {
+        uint32_t lcg = 12345;
+        for (uint32_t i = 0; i < SAMPLE_COUNT; ++i)
+        {
+            lcg = lcg * 1664525u + 1013904223u;
+            const int32_t raw = static_cast<int32_t>((lcg >> 8) % 1251) - 400;
+            g_fixed[i] = Fixed::fromRaw(raw);
+            g_float[i] = raw / 10.0f;
+        }
+    }
+
+    int64_t floatToScaled(float value)
+    {
+        return static_cast<int64_t>(std::lround(value * static_cast<float>(Fixed::SCALE)));
+    }
+
+    void row(const char* path, double fixedNs, double floatNs)
+    {
+        std::printf("%-10s %10.1f %10.1f %8.1fx\n", path, fixedNs, floatNs, floatNs / fixedNs);
+    }
+}
+
+int main()
+{
+    makeSamples();
+    char buf[Fixed::MAX_CHARS];
+
+    const double fixedFormat = benchNsPerOp(ITERATIONS, [&](uint32_t i) {
+        g_benchSink = g_benchSink + g_fixed[i & (SAMPLE_COUNT - 1)].toChars(buf, sizeof(buf));
+    });
+    const double floatFormat = benchNsPerOp(ITERATIONS, [&](uint32_t i) {
+        g_benchSink = g_benchSink + std::snprintf(buf, sizeof(buf), "%.1f", g_float[i & (SAMPLE_COUNT - 1)]);
+    });
+
+    const double fixedPublish = benchNsPerOp(ITERATIONS, [&](uint32_t i) {
+        g_benchSink = g_benchSink + g_fixed[i & (SAMPLE_COUNT - 1)].raw();
+    });
+    const double floatPublish = benchNsPerOp(ITERATIONS, [&](uint32_t i) {
+        g_benchSink = g_benchSink + floatToScaled(g_float[i & (SAMPLE_COUNT - 1)]);
+    });
+
+    const double fixedCombined = benchNsPerOp(ITERATIONS, [&](uint32_t i) {
+        const Fixed& v = g_fixed[i & (SAMPLE_COUNT - 1)];
+        g_benchSink = g_benchSink + v.raw() + v.toChars(buf, sizeof(buf));
+    });
+    const double floatCombined = benchNsPerOp(ITERATIONS, [&](uint32_t i) {
+        const float v = g_float[i & (SAMPLE_COUNT - 1)];
+        g_benchSink = g_benchSink + floatToScaled(v) + std::snprintf(buf, sizeof(buf), "%.1f", v);
+    });
+
+    std::printf("%-10s %10s %10s %9s\n", "path", "fixed ns", "float ns", "ratio");
+    row("format", fixedFormat, floatFormat);
+    row("publish", fixedPublish, floatPublish);
+    row("combined", fixedCombined, floatCombined);
+    return 0;
+}
@@ -0,0 +1,98 @@
+/*
+  sample_filter_bench.cpp - Host benchmark of the IoTSampleFilter stages:
+  cost per sample and RAM (STATE_SIZE) per stage.
+
+  Build and run from the repository root:
+    g++ -std=c++17 -O2 -Wall -Wextra -Isrc tools/bench/sample_filter_bench.cpp -o sample_filter_bench
+    ./sample_filter_bench
+
+  Host numbers are relative: an ESP8266 is much slower and has no FPU, so
+  the float rows are far more expensive there than the int32 rows.
+
+  Copyright (c) 2024 Peter Kaleja.  All right reserved.
+
+  This library is free software; you can redistribute it and/or
+  modify it under the terms of the GNU Lesser General Public
+  License as published by the Free Software Foundation; either
+  version 2.1 of the License, or (at your option) any later version.
+
+  This library is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+  Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this library; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+*/
+
+#include "IoTSampleFilter.h"
+#include "bench_util.h"
+
+namespace
+{
+    constexpr uint32_t ITERATIONS = 2000000;
+    constexpr uint32_t SAMPLE_COUNT = 1024;   // power of two
+
+    int32_t g_samples[SAMPLE_COUNT];
+
+    // Noisy ramp with occasional spikes, 0.1 unit resolution
+    void makeSamples()
+    {
+        uint32_t lcg = 12345;
+        for (uint32_t i = 0; i < SAMPLE_COUNT; ++i)
+        {
+            lcg = lcg * 1664525u + 1013904223u;
+            const int32_t noise = static_cast<int32_t>((lcg >> 16) % 21) - 10;
+            const int32_t spike = (i % 97 == 0) ? 500 : 0;
+            g_samples[i] = 215 + static_cast<int32_t>(i % 64) + noise + spike;
+        }
+    }
+
+    template<typename T>
+    T sampleAt(uint32_t i);
+
+    template<>
+    IoTFixedPoint<1> sampleAt(uint32_t i) { return IoTFixedPoint<1>::fromRaw(g_samples[i & (SAMPLE_COUNT - 1)]); }
+
+    template<>
+    float sampleAt(uint32_t i) { return g_samples[i & (SAMPLE_COUNT - 1)] / 10.0f; }
+
+    int64_t sinkValue(const IoTFixedPoint<1>& v) { return v.raw(); }
+    int64_t sinkValue(float v) { return static_cast<int64_t>(v); }
+
+    template<typename T, typename... Stages>
+    void run(const char* name, const char* type)
+    {
+        IoTSampleFilter<T, Stages...> filter;
+        const double ns = benchNsPerOp(ITERATIONS, [&](uint32_t i) {
+            T out{};
+            if (filter.push(sampleAt<T>(i), out))
+            {
+                g_benchSink = g_benchSink + sinkValue(out);
+            }
+        });
+        std::printf("%-28s %-8s %8.1f %10zu\n", name, type, ns, IoTSampleFilter<T, Stages...>::STATE_SIZE);
+    }
+
+    template<typename T>
+    void runAll(const char* type)
+    {
+        run<T, IoTMedian<3>>("IoTMedian<3>", type);
+        run<T, IoTMedian<5>>("IoTMedian<5>", type);
+        run<T, IoTMedian<9>>("IoTMedian<9>", type);
+        run<T, IoTEma<20>>("IoTEma<20>", type);
+        run<T, IoTKalman<1, 16>>("IoTKalman<1,16>", type);
+        run<T, IoTOversample<4>>("IoTOversample<4>", type);
+        run<T, IoTMedian<5>, IoTEma<20>>("IoTMedian<5>+IoTEma<20>", type);
+    }
+}
+
+int main()
+{
+    makeSamples();
+    std::printf("%-28s %-8s %8s %10s\n", "stage", "type", "ns/smpl", "STATE_SIZE");
+    runAll<IoTFixedPoint<1>>("int32");
+    runAll<float>("float");
+    return 0;
+}
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""Embed web assets as gzipped PROGMEM arrays for IoTStaticAsset.
+
+Usage:
+    tools/gzip_assets.py -o src/IoTGeneratedAssets.h data/hw-status.js
+
+For every input file the generated header defines
+
+    const uint8_t IOT_ASSET_<NAME>_DATA[] PROGMEM = { ...gzip... };
+    const char    IOT_ASSET_<NAME>_ETAG[] PROGMEM = "\"<hash>\"";
+    const IoTStaticAsset IOT_ASSET_<NAME> = { ... };
+    #define IOT_ASSET_<NAME>_GZ 1
+
+where <NAME> is the file name upper-cased with non-alphanumerics replaced by
+'_' (hw-status.js -> HW_STATUS_JS) and <hash> the first 8 hex digits of the
+SHA-256 of the uncompressed content. Output is reproducible (gzip mtime 0),
+so the header only changes when an asset changes.
+"""
+
+import argparse
+import gzip
+import hashlib
+import mimetypes
+import os
+import re
+import sys
+
+CONTENT_TYPES = {
+    '.js': 'application/javascript',
+    '.css': 'text/css',
+    '.html': 'text/html',
+    '.htm': 'text/html',
+    '.json': 'application/json',
+    '.svg': 'image/svg+xml',
+    '.ico': 'image/x-icon',
+}
+
+
+def symbol_name(path):
+    return 'IOT_ASSET_' + re.sub(r'[^A-Za-z0-9]', '_', os.path.basename(path)).upper()
+
+
+def content_type(path):
+    ext = os.path.splitext(path)[1].lower()
+    return CONTENT_TYPES.get(ext) or mimetypes.guess_type(path)[0] or 'application/octet-stream'
+
+
+def embed(path):
+    with open(path, 'rb') as f:
+        raw = f.read()
+    packed = gzip.compress(raw, compresslevel=9, mtime=0)
+    etag = hashlib.sha256(raw).hexdigest()[:8]
+    name = symbol_name(path)
+
+    lines = ['// %s: %d -> %d bytes (%d%%)' % (
+        os.path.basename(path), len(raw), len(packed),
+        100 - (100 * len(packed) // max(len(raw), 1)))]
+    lines.append('const uint8_t %s_DATA[] PROGMEM = {' % name)
+    for i in range(0, len(packed), 16):
+        lines.append('    ' + ', '.join('0x%02x' % b for b in packed[i:i + 16]) + ',')
+    lines.append('};')
+    lines.append('const char %s_TYPE[] PROGMEM = "%s";' % (name, content_type(path)))
+    lines.append('const char %s_ETAG[] PROGMEM = "\\"%s\\"";' % (name, etag))
+    lines.append('const IoTStaticAsset %s = { %s_TYPE, %s_DATA, sizeof(%s_DATA), true, %s_ETAG };'
+                 % (name, name, name, name, name))
+    lines.append('#define %s_GZ 1' % name)
+    return '\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('-o', '--output', required=True, help='header to generate')
+    parser.add_argument('assets', nargs='+', help='files to embed')
+    args = parser.parse_args()
+
+    parts = [
+        '// Generated by tools/gzip_assets.py - do not edit.',
+        '#pragma once',
+        '',
+        '#include "IoTStaticAsset.h"',
+        '',
+    ]
+    parts += [embed(path) + '\n' for path in args.assets]
+
+    text = '\n'.join(parts)
+    if os.path.exists(args.output):
+        with open(args.output) as f:
+            if f.read() == text:
+                return 0
+    with open(args.output, 'w') as f:
+        f.write(text)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())